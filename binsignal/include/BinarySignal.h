@@ -1,46 +1,127 @@
 #ifndef BINARY_SIGNAL_H
 #define BINARY_SIGNAL_H
 
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "BinarySignalView.h"
+#include "SignalFile.h"
 #include "SignalState.h"
 
 namespace lab2{
 
+#define RESAMPLE_ROUND 0
+#define RESAMPLE_ANY 1
+#define RESAMPLE_MAJORITY 2
+
+  class RepeatedSignal;
+
   class BinarySignal{
     friend std::ostream &operator <<(std::ostream &output, const BinarySignal &signal);
     friend std::istream &operator >>(std::istream &input, BinarySignal &signal);
   private:
+    bool level;
     int count;
-    SignalState *signal;
+    int capacity;
+    std::int64_t total;
+    std::int64_t *times;
+    std::int64_t *ends;
+    std::atomic<int> *refs;
+    bool runLevel(int index) const;
+    void grow(int min_capacity);
+    void reallocate(int new_capacity);
+    void release();
+    void detach();
+    void pushRun(bool run_level, std::int64_t time);
+    void appendRuns(bool first_level, const std::int64_t *runs, int n);
+    void updateIndex(int from);
+    std::int64_t timeBefore(int index) const;
+    template <class Count, class Find, class Level>
+    void encodeRuns(std::size_t length, Count count_chunk, Find find, Level level_at);
+    template <class Sink>
+    void render(Sink &sink, bool formated) const;
+    template <class Op>
+    BinarySignal combine(const BinarySignal &other, Op op) const;
   public:
-    BinarySignal() : count(0), signal(nullptr) {}
-    BinarySignal(int level, int time);
-    BinarySignal(std::string signal_str);
+    BinarySignal() : level(false), count(0), capacity(0), total(0), times(nullptr), ends(nullptr), refs(nullptr) {}
+    BinarySignal(int level, std::int64_t time);
+    BinarySignal(std::string_view signal_str);
+    explicit BinarySignal(std::span<const std::uint8_t> samples);
+    explicit BinarySignal(std::span<const int> samples);
+    BinarySignal(std::span<const std::uint64_t> bits, std::size_t bit_count);
+    explicit BinarySignal(const BinarySignalView &view);
     BinarySignal(const BinarySignal& other);
     ~BinarySignal(){
-      delete[] signal;
+      release();
     }
     BinarySignal(BinarySignal&& other) noexcept;
 
+    static BinarySignal fromSamples(std::span<const std::uint8_t> samples);
+    static BinarySignal fromSamples(std::span<const int> samples);
+    static BinarySignal fromSamples(std::span<const std::uint64_t> bits, std::size_t bit_count);
+    static BinarySignal load(std::istream &input);
+
     int getCount() const;
+    SignalState getState(int index) const;
+    int getCapacity() const;
+    void reserve(int new_capacity);
+    void shrinkToFit();
+    void buildTimeIndex();
+    void dropTimeIndex();
+    bool hasTimeIndex() const;
+    bool isShared() const;
+    BinarySignalView view() const;
+    BinarySignalView slice(std::int64_t time, std::int64_t duration) const;
+    RunIterator begin() const;
+    RunIterator end() const;
+    SampleRange samples() const;
+    EdgeRange edges() const;
+    EdgeRange risingEdges() const;
+    EdgeRange fallingEdges() const;
+    std::size_t copyEdges(std::span<Edge> buffer, int kind = EDGE_ANY) const;
+    int runIndexAt(std::int64_t time) const;
+    std::size_t sampleAt(std::span<const std::int64_t> sorted_times, std::span<std::uint8_t> out) const;
+    std::size_t sampleAtUnsorted(std::span<const std::int64_t> times, std::span<std::uint8_t> out) const;
+    void normalize();
+    BinarySignal &debounce(std::int64_t min_width);
+    BinarySignal &debounce(std::int64_t min_high, std::int64_t min_low);
+    bool isCanonical() const;
     std::string toString() const;
+    std::vector<std::uint64_t> toBits() const;
+    std::size_t toBits(std::span<std::uint64_t> bits) const;
 
     BinarySignal& operator =(BinarySignal&& other) noexcept;
 
     BinarySignal operator ~();
+    BinarySignalView operator ~() const;
     BinarySignal &operator =(const BinarySignal &other);
     BinarySignal &operator *=(int n);
     BinarySignal operator *(int n) const;
+    RepeatedSignal repeat(std::int64_t n) const;
+    BinarySignal resample(std::int64_t num, std::int64_t den, int policy = RESAMPLE_ROUND) const;
     BinarySignal &operator +=(const BinarySignal &other);
     BinarySignal &operator +=(const SignalState &other);
-    bool operator[](int time);
+    BinarySignal operator &(const BinarySignal &other) const;
+    BinarySignal operator |(const BinarySignal &other) const;
+    BinarySignal operator ^(const BinarySignal &other) const;
+    BinarySignal &operator &=(const BinarySignal &other);
+    BinarySignal &operator |=(const BinarySignal &other);
+    BinarySignal &operator ^=(const BinarySignal &other);
+    bool operator[](std::int64_t time) const;
 
     void input(int input_format);
     void output() const;
-    int totalTime();
+    std::int64_t totalTime() const;
     void invertSignal();
     std::string formatedSignal() const;
-    BinarySignal &insertSignal(const BinarySignal &other, int time);
-    BinarySignal &removeSignal(int time, int duration);
+    void write(std::ostream &output) const;
+    void writeFormated(std::ostream &output) const;
+    void save(std::ostream &output, int encoding = FIXED_ENCODING, bool time_index = false) const;
+    BinarySignal &insertSignal(const BinarySignal &other, std::int64_t time);
+    BinarySignal &removeSignal(std::int64_t time, std::int64_t duration);
   };
   
 }
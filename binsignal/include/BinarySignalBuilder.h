@@ -0,0 +1,36 @@
+#ifndef BINARY_SIGNAL_BUILDER_H
+#define BINARY_SIGNAL_BUILDER_H
+
+#include <cstdint>
+#include <span>
+
+#include "BinarySignal.h"
+
+namespace lab2{
+
+class BinarySignalBuilder {
+private:
+  BinarySignal signal;
+  std::int64_t horizon;
+  std::int64_t dropped;
+  void trim();
+public:
+  BinarySignalBuilder();
+  explicit BinarySignalBuilder(std::int64_t horizon);
+
+  BinarySignalBuilder &append(bool level, std::int64_t time = 1);
+  BinarySignalBuilder &append(std::span<const std::uint8_t> samples);
+  BinarySignalBuilder &append(std::span<const int> samples);
+  BinarySignalBuilder &append(const BinarySignal &block);
+
+  BinarySignal snapshot() const;
+  int getCount() const;
+  std::int64_t totalTime() const;
+  std::int64_t droppedTime() const;
+  std::int64_t getHorizon() const;
+  void clear();
+};
+
+}
+
+#endif //BINARY_SIGNAL_BUILDER_H
@@ -0,0 +1,295 @@
+#ifndef BINARY_SIGNAL_VIEW_H
+#define BINARY_SIGNAL_VIEW_H
+
+#include <cstddef>
+#include <compare>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "SignalState.h"
+
+namespace lab2{
+
+#define EDGE_ANY 0
+#define EDGE_RISING 1
+#define EDGE_FALLING 2
+
+#define SAMPLE_OUT_OF_RANGE 0xFF
+
+struct Edge {
+  std::int64_t time;
+  bool rising;
+  bool operator ==(const Edge &other) const = default;
+};
+
+class RunIterator;
+class SampleIterator;
+class SampleRange;
+class EdgeIterator;
+class EdgeRange;
+class SignalStats;
+
+class BinarySignalView {
+  friend class RunIterator;
+  friend class SampleIterator;
+  friend class EdgeIterator;
+  friend class SignalStats;
+private:
+  bool level;
+  int count;
+  const std::int64_t *times;
+  const std::int64_t *ends;
+  std::int64_t total;
+  std::int64_t head;
+  std::int64_t tail;
+  std::int64_t base;
+  std::int64_t runTime(int index) const;
+  std::int64_t timeBefore(int index) const;
+  BinarySignalView cut(int first, std::int64_t first_start, int last, std::int64_t last_start, std::int64_t time, std::int64_t duration) const;
+public:
+  BinarySignalView() : level(false), count(0), times(nullptr), ends(nullptr), total(0), head(0), tail(0), base(0) {}
+  BinarySignalView(const void *data, std::size_t size, bool validate = true);
+  BinarySignalView(bool level, int count, const std::int64_t *times, const std::int64_t *ends, std::int64_t total);
+
+  int getCount() const;
+  bool hasTimeIndex() const;
+  std::int64_t totalTime() const;
+  SignalState getState(int index) const;
+  int runIndexAt(std::int64_t time) const;
+  bool operator [](std::int64_t time) const;
+  BinarySignalView operator ~() const;
+  BinarySignalView slice(std::int64_t time, std::int64_t duration) const;
+  std::size_t sampleAt(std::span<const std::int64_t> sorted_times, std::span<std::uint8_t> out) const;
+  std::size_t sampleAtUnsorted(std::span<const std::int64_t> times, std::span<std::uint8_t> out) const;
+
+  RunIterator begin() const;
+  RunIterator end() const;
+  SampleRange samples() const;
+  EdgeRange edges(int kind = EDGE_ANY) const;
+  EdgeRange risingEdges() const;
+  EdgeRange fallingEdges() const;
+  std::size_t copyEdges(std::span<Edge> buffer, int kind = EDGE_ANY) const;
+
+  std::string toString() const;
+  void write(std::ostream &output) const;
+};
+
+class RunIterator {
+public:
+  using iterator_concept = std::random_access_iterator_tag;
+  using iterator_category = std::input_iterator_tag;
+  using value_type = SignalState;
+  using difference_type = std::ptrdiff_t;
+
+  RunIterator() : index(0) {}
+  RunIterator(const BinarySignalView &view, difference_type index) : view(view), index(index) {}
+
+  SignalState operator *() const {
+    return SignalState(view.level != (index % 2 != 0), view.runTime((int)index));
+  }
+  SignalState operator [](difference_type n) const {
+    return *(*this + n);
+  }
+  RunIterator &operator ++(){
+    index++;
+    return *this;
+  }
+  RunIterator operator ++(int){
+    RunIterator result = *this;
+    index++;
+    return result;
+  }
+  RunIterator &operator --(){
+    index--;
+    return *this;
+  }
+  RunIterator operator --(int){
+    RunIterator result = *this;
+    index--;
+    return result;
+  }
+  RunIterator &operator +=(difference_type n){
+    index += n;
+    return *this;
+  }
+  RunIterator &operator -=(difference_type n){
+    index -= n;
+    return *this;
+  }
+  friend RunIterator operator +(RunIterator it, difference_type n){
+    return it += n;
+  }
+  friend RunIterator operator +(difference_type n, RunIterator it){
+    return it += n;
+  }
+  friend RunIterator operator -(RunIterator it, difference_type n){
+    return it -= n;
+  }
+  friend difference_type operator -(const RunIterator &a, const RunIterator &b){
+    return a.index - b.index;
+  }
+  friend bool operator ==(const RunIterator &a, const RunIterator &b){
+    return a.index == b.index;
+  }
+  friend std::strong_ordering operator <=>(const RunIterator &a, const RunIterator &b){
+    return a.index <=> b.index;
+  }
+private:
+  BinarySignalView view;
+  difference_type index;
+};
+
+class SampleIterator {
+public:
+  using iterator_concept = std::forward_iterator_tag;
+  using iterator_category = std::input_iterator_tag;
+  using value_type = bool;
+  using difference_type = std::ptrdiff_t;
+
+  SampleIterator() : run(0), left(0), time(0) {}
+  SampleIterator(const BinarySignalView &view, std::int64_t time) : view(view), run(0), left(0), time(time) {
+    if (time == 0 && view.count != 0){
+      left = view.runTime(0);
+    }
+  }
+
+  bool operator *() const {
+    return view.level != (run % 2 != 0);
+  }
+  SampleIterator &operator ++(){
+    time++;
+    if (--left == 0 && ++run < view.count){
+      left = view.runTime(run);
+    }
+    return *this;
+  }
+  SampleIterator operator ++(int){
+    SampleIterator result = *this;
+    ++*this;
+    return result;
+  }
+  friend difference_type operator -(const SampleIterator &a, const SampleIterator &b){
+    return a.time - b.time;
+  }
+  friend bool operator ==(const SampleIterator &a, const SampleIterator &b){
+    return a.time == b.time;
+  }
+private:
+  BinarySignalView view;
+  int run;
+  std::int64_t left;
+  std::int64_t time;
+};
+
+class SampleRange : public std::ranges::view_interface<SampleRange> {
+public:
+  SampleRange() = default;
+  explicit SampleRange(const BinarySignalView &view) : view(view) {}
+  SampleIterator begin() const {
+    return SampleIterator(view, 0);
+  }
+  SampleIterator end() const {
+    return SampleIterator(view, view.totalTime());
+  }
+private:
+  BinarySignalView view;
+};
+
+class EdgeIterator {
+public:
+  using iterator_concept = std::forward_iterator_tag;
+  using iterator_category = std::input_iterator_tag;
+  using value_type = Edge;
+  using difference_type = std::ptrdiff_t;
+
+  EdgeIterator() : run(0), step(1), time(0) {}
+  EdgeIterator(const BinarySignalView &view, int kind) : view(view), run(1), step(kind == EDGE_ANY ? 1 : 2), time(0) {
+    if (view.count != 0){
+      time = view.runTime(0);
+    }
+    if (kind != EDGE_ANY && view.count > 1 && (view.level == (kind == EDGE_RISING))){
+      time += view.runTime(1);
+      run = 2;
+    }
+  }
+
+  Edge operator *() const {
+    return Edge{time, view.level != (run % 2 != 0)};
+  }
+  EdgeIterator &operator ++(){
+    for (int i = 0; i < step && run < view.count; i++){
+      time += view.runTime(run);
+      run++;
+    }
+    return *this;
+  }
+  EdgeIterator operator ++(int){
+    EdgeIterator result = *this;
+    ++*this;
+    return result;
+  }
+  friend bool operator ==(const EdgeIterator &a, const EdgeIterator &b){
+    return a.run == b.run;
+  }
+  friend bool operator ==(const EdgeIterator &it, std::default_sentinel_t){
+    return it.run >= it.view.getCount();
+  }
+private:
+  BinarySignalView view;
+  int run;
+  int step;
+  std::int64_t time;
+};
+
+class EdgeRange : public std::ranges::view_interface<EdgeRange> {
+public:
+  EdgeRange() : kind(EDGE_ANY) {}
+  EdgeRange(const BinarySignalView &view, int kind) : view(view), kind(kind) {}
+  EdgeIterator begin() const {
+    return EdgeIterator(view, kind);
+  }
+  std::default_sentinel_t end() const {
+    return std::default_sentinel;
+  }
+private:
+  BinarySignalView view;
+  int kind;
+};
+
+/**
+ * @brief Get an iterator to the first run of the view.
+ */
+inline RunIterator BinarySignalView::begin() const {
+  return RunIterator(*this, 0);
+}
+
+/**
+ * @brief Get an iterator past the last run of the view.
+ */
+inline RunIterator BinarySignalView::end() const {
+  return RunIterator(*this, count);
+}
+
+/**
+ * @brief Get the range of levels of the view, one per time unit.
+ *
+ * The levels are produced by walking the runs, the signal is not expanded.
+ */
+inline SampleRange BinarySignalView::samples() const {
+  return SampleRange(*this);
+}
+
+}
+
+template <>
+inline constexpr bool std::ranges::enable_borrowed_range<lab2::BinarySignalView> = true;
+template <>
+inline constexpr bool std::ranges::enable_borrowed_range<lab2::SampleRange> = true;
+template <>
+inline constexpr bool std::ranges::enable_borrowed_range<lab2::EdgeRange> = true;
+
+#endif //BINARY_SIGNAL_VIEW_H
@@ -0,0 +1,64 @@
+#ifndef CONCURRENT_SIGNAL_H
+#define CONCURRENT_SIGNAL_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "BinarySignal.h"
+
+namespace lab2{
+
+#define CONCURRENT_CHUNK_RUNS 4096
+#define CONCURRENT_DIRECTORY_SIZE 65536
+
+class ConcurrentSignal {
+private:
+  struct Chunk {
+    std::int64_t times[CONCURRENT_CHUNK_RUNS];
+    std::int64_t ends[CONCURRENT_CHUNK_RUNS];
+  };
+  std::atomic<Chunk *> *directory;
+  std::atomic<std::uint64_t> sequence;
+  std::atomic<bool> first_level;
+  std::atomic<std::int64_t> published_count;
+  std::atomic<std::int64_t> published_last;
+  std::atomic<std::int64_t> published_total;
+  bool level;
+  std::int64_t count;
+  std::int64_t last_time;
+  std::int64_t total;
+  void closeLastRun();
+public:
+  class Snapshot {
+    friend class ConcurrentSignal;
+  private:
+    const std::atomic<Chunk *> *directory;
+    bool level;
+    std::int64_t count;
+    std::int64_t last_time;
+    std::int64_t total;
+    std::int64_t endOf(std::int64_t index) const;
+  public:
+    Snapshot() : directory(nullptr), level(false), count(0), last_time(0), total(0) {}
+
+    std::int64_t getCount() const;
+    SignalState getState(std::int64_t index) const;
+    std::int64_t runIndexAt(std::int64_t time) const;
+    std::int64_t totalTime() const;
+    bool operator [](std::int64_t time) const;
+    BinarySignal toSignal() const;
+  };
+
+  ConcurrentSignal();
+  ~ConcurrentSignal();
+  ConcurrentSignal(const ConcurrentSignal &other) = delete;
+  ConcurrentSignal &operator =(const ConcurrentSignal &other) = delete;
+
+  void append(bool level, std::int64_t time);
+  void append(const BinarySignal &signal);
+  Snapshot snapshot() const;
+};
+
+}
+
+#endif //CONCURRENT_SIGNAL_H
@@ -0,0 +1,38 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+
+namespace lab2{
+
+#define PARALLEL_MIN_CHUNK (1 << 16)
+
+  unsigned parallelThreads();
+  void setParallelThreads(unsigned threads);
+  std::size_t parallelChunks(std::size_t length);
+
+  bool parallelRun(std::size_t chunks, std::size_t threads, void (*call)(void *context, std::size_t chunk), void *context);
+
+/**
+ * @brief Calls body(k) for every k in [0, chunks) on up to parallelThreads() threads.
+ *
+ * The chunks are handed out one at a time to the calling thread and to the workers of a pool
+ * that lives for the whole program. Nested calls and calls made while another thread uses
+ * the pool run serially. Returns when every chunk is done; the first exception thrown by body is rethrown.
+ */
+  template <class Body>
+  void parallelFor(std::size_t chunks, Body body){
+    std::size_t threads = std::min<std::size_t>(parallelThreads(), chunks);
+    auto call = [](void *context, std::size_t chunk){ (*static_cast<Body *>(context))(chunk); };
+    if (threads > 1 && parallelRun(chunks, threads, call, &body)){
+      return;
+    }
+    for (std::size_t k = 0; k < chunks; k++){
+      body(k);
+    }
+  }
+
+}
+
+#endif //PARALLEL_H
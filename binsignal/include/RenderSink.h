@@ -0,0 +1,48 @@
+#ifndef RENDER_SINK_H
+#define RENDER_SINK_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+namespace lab2{
+
+class BufferSink {
+public:
+  explicit BufferSink(char *data) : data(data) {}
+  void put(char symbol, std::size_t n){
+    std::memset(data, symbol, n);
+    data += n;
+  }
+private:
+  char *data;
+};
+
+class StreamSink {
+public:
+  explicit StreamSink(std::ostream &output) : output(output), used(0) {}
+  void put(char symbol, std::size_t n){
+    while (n != 0){
+      std::size_t part = std::min(n, sizeof(buffer) - used);
+      std::memset(buffer + used, symbol, part);
+      used += part;
+      n -= part;
+      if (used == sizeof(buffer)){
+        flush();
+      }
+    }
+  }
+  void flush(){
+    output.write(buffer, used);
+    used = 0;
+  }
+private:
+  std::ostream &output;
+  char buffer[4096];
+  std::size_t used;
+};
+
+}
+
+#endif //RENDER_SINK_H
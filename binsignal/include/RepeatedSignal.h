@@ -0,0 +1,257 @@
+#ifndef REPEATED_SIGNAL_H
+#define REPEATED_SIGNAL_H
+
+#include <compare>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <string>
+
+#include "BinarySignal.h"
+
+namespace lab2{
+
+class RepeatedRunIterator;
+class RepeatedSampleRange;
+class RepeatedEdgeRange;
+
+class RepeatedSignal {
+private:
+  BinarySignal pattern;
+  std::int64_t repeats;
+  std::int64_t total;
+public:
+  RepeatedSignal(const BinarySignal &pattern, std::int64_t repeats);
+
+  const BinarySignal &getPattern() const;
+  std::int64_t getRepeats() const;
+  std::int64_t getCount() const;
+  SignalState getState(std::int64_t index) const;
+  std::int64_t runIndexAt(std::int64_t time) const;
+  std::int64_t totalTime() const;
+  bool operator [](std::int64_t time) const;
+
+  RepeatedRunIterator begin() const;
+  RepeatedRunIterator end() const;
+  RepeatedSampleRange samples() const;
+  RepeatedEdgeRange edges(int kind = EDGE_ANY) const;
+
+  BinarySignal materialize() const;
+  std::string toString() const;
+  void write(std::ostream &output) const;
+};
+
+class RepeatedRunIterator {
+public:
+  using iterator_concept = std::random_access_iterator_tag;
+  using iterator_category = std::input_iterator_tag;
+  using value_type = SignalState;
+  using difference_type = std::ptrdiff_t;
+
+  RepeatedRunIterator() : signal(nullptr), index(0) {}
+  RepeatedRunIterator(const RepeatedSignal &signal, difference_type index) : signal(&signal), index(index) {}
+
+  SignalState operator *() const {
+    return signal->getState(index);
+  }
+  SignalState operator [](difference_type n) const {
+    return *(*this + n);
+  }
+  RepeatedRunIterator &operator ++(){
+    index++;
+    return *this;
+  }
+  RepeatedRunIterator operator ++(int){
+    RepeatedRunIterator result = *this;
+    index++;
+    return result;
+  }
+  RepeatedRunIterator &operator --(){
+    index--;
+    return *this;
+  }
+  RepeatedRunIterator operator --(int){
+    RepeatedRunIterator result = *this;
+    index--;
+    return result;
+  }
+  RepeatedRunIterator &operator +=(difference_type n){
+    index += n;
+    return *this;
+  }
+  RepeatedRunIterator &operator -=(difference_type n){
+    index -= n;
+    return *this;
+  }
+  friend RepeatedRunIterator operator +(RepeatedRunIterator it, difference_type n){
+    return it += n;
+  }
+  friend RepeatedRunIterator operator +(difference_type n, RepeatedRunIterator it){
+    return it += n;
+  }
+  friend RepeatedRunIterator operator -(RepeatedRunIterator it, difference_type n){
+    return it -= n;
+  }
+  friend difference_type operator -(const RepeatedRunIterator &a, const RepeatedRunIterator &b){
+    return a.index - b.index;
+  }
+  friend bool operator ==(const RepeatedRunIterator &a, const RepeatedRunIterator &b){
+    return a.index == b.index;
+  }
+  friend std::strong_ordering operator <=>(const RepeatedRunIterator &a, const RepeatedRunIterator &b){
+    return a.index <=> b.index;
+  }
+private:
+  const RepeatedSignal *signal;
+  difference_type index;
+};
+
+class RepeatedSampleIterator {
+public:
+  using iterator_concept = std::forward_iterator_tag;
+  using iterator_category = std::input_iterator_tag;
+  using value_type = bool;
+  using difference_type = std::ptrdiff_t;
+
+  RepeatedSampleIterator() : signal(nullptr), run(0), left(0), time(0), level(false) {}
+  RepeatedSampleIterator(const RepeatedSignal &signal, std::int64_t time) : signal(&signal), run(0), left(0), time(time), level(false) {
+    if (time == 0 && signal.getCount() != 0){
+      SignalState state = signal.getState(0);
+      left = state.getTime();
+      level = state.getLevel();
+    }
+  }
+
+  bool operator *() const {
+    return level;
+  }
+  RepeatedSampleIterator &operator ++(){
+    time++;
+    if (--left == 0 && ++run < signal->getCount()){
+      SignalState state = signal->getState(run);
+      left = state.getTime();
+      level = state.getLevel();
+    }
+    return *this;
+  }
+  RepeatedSampleIterator operator ++(int){
+    RepeatedSampleIterator result = *this;
+    ++*this;
+    return result;
+  }
+  friend difference_type operator -(const RepeatedSampleIterator &a, const RepeatedSampleIterator &b){
+    return a.time - b.time;
+  }
+  friend bool operator ==(const RepeatedSampleIterator &a, const RepeatedSampleIterator &b){
+    return a.time == b.time;
+  }
+private:
+  const RepeatedSignal *signal;
+  std::int64_t run;
+  std::int64_t left;
+  std::int64_t time;
+  bool level;
+};
+
+class RepeatedSampleRange : public std::ranges::view_interface<RepeatedSampleRange> {
+public:
+  RepeatedSampleRange() : signal(nullptr) {}
+  explicit RepeatedSampleRange(const RepeatedSignal &signal) : signal(&signal) {}
+  RepeatedSampleIterator begin() const {
+    return RepeatedSampleIterator(*signal, 0);
+  }
+  RepeatedSampleIterator end() const {
+    return RepeatedSampleIterator(*signal, signal->totalTime());
+  }
+private:
+  const RepeatedSignal *signal;
+};
+
+class RepeatedEdgeIterator {
+public:
+  using iterator_concept = std::forward_iterator_tag;
+  using iterator_category = std::input_iterator_tag;
+  using value_type = Edge;
+  using difference_type = std::ptrdiff_t;
+
+  RepeatedEdgeIterator() : signal(nullptr), count(0), run(0), step(1), time(0) {}
+  RepeatedEdgeIterator(const RepeatedSignal &signal, int kind) : signal(&signal), count(signal.getCount()), run(1), step(kind == EDGE_ANY ? 1 : 2), time(0) {
+    if (count != 0){
+      time = signal.getState(0).getTime();
+    }
+    if (kind != EDGE_ANY && count > 1 && (signal.getState(0).getLevel() == (kind == EDGE_RISING))){
+      time += signal.getState(1).getTime();
+      run = 2;
+    }
+  }
+
+  Edge operator *() const {
+    return Edge{time, signal->getState(run).getLevel()};
+  }
+  RepeatedEdgeIterator &operator ++(){
+    for (int i = 0; i < step && run < count; i++){
+      time += signal->getState(run).getTime();
+      run++;
+    }
+    return *this;
+  }
+  RepeatedEdgeIterator operator ++(int){
+    RepeatedEdgeIterator result = *this;
+    ++*this;
+    return result;
+  }
+  friend bool operator ==(const RepeatedEdgeIterator &a, const RepeatedEdgeIterator &b){
+    return a.run == b.run;
+  }
+  friend bool operator ==(const RepeatedEdgeIterator &it, std::default_sentinel_t){
+    return it.run >= it.count;
+  }
+private:
+  const RepeatedSignal *signal;
+  std::int64_t count;
+  std::int64_t run;
+  int step;
+  std::int64_t time;
+};
+
+class RepeatedEdgeRange : public std::ranges::view_interface<RepeatedEdgeRange> {
+public:
+  RepeatedEdgeRange() : signal(nullptr), kind(EDGE_ANY) {}
+  RepeatedEdgeRange(const RepeatedSignal &signal, int kind) : signal(&signal), kind(kind) {}
+  RepeatedEdgeIterator begin() const {
+    return RepeatedEdgeIterator(*signal, kind);
+  }
+  std::default_sentinel_t end() const {
+    return std::default_sentinel;
+  }
+private:
+  const RepeatedSignal *signal;
+  int kind;
+};
+
+/**
+ * @brief Get an iterator to the first run of the repeated signal.
+ */
+inline RepeatedRunIterator RepeatedSignal::begin() const {
+  return RepeatedRunIterator(*this, 0);
+}
+
+/**
+ * @brief Get an iterator past the last run of the repeated signal.
+ */
+inline RepeatedRunIterator RepeatedSignal::end() const {
+  return RepeatedRunIterator(*this, getCount());
+}
+
+/**
+ * @brief Get the range of levels of the repeated signal, one per time unit.
+ *
+ * The levels are produced by walking the runs, the repetitions are not expanded.
+ */
+inline RepeatedSampleRange RepeatedSignal::samples() const {
+  return RepeatedSampleRange(*this);
+}
+
+}
+
+#endif //REPEATED_SIGNAL_H
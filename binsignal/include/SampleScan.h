@@ -0,0 +1,20 @@
+#ifndef SAMPLE_SCAN_H
+#define SAMPLE_SCAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lab2{
+
+  std::size_t countByteTransitions(const std::uint8_t *data, std::size_t length);
+  std::size_t findByteTransition(const std::uint8_t *data, std::size_t length, std::size_t from, bool level);
+  std::size_t countIntTransitions(const int *data, std::size_t length);
+  std::size_t findIntTransition(const int *data, std::size_t length, std::size_t from, bool level);
+  std::size_t countBitTransitions(const std::uint64_t *bits, std::size_t bit_count);
+  std::size_t findBitTransition(const std::uint64_t *bits, std::size_t bit_count, std::size_t from, bool level);
+  const char *sampleScanKernel();
+  bool setSampleScanKernel(const char *name);
+
+}
+
+#endif //SAMPLE_SCAN_H
@@ -0,0 +1,36 @@
+#ifndef SIGNAL_FILE_H
+#define SIGNAL_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "BinarySignalView.h"
+
+namespace lab2{
+
+#define FIXED_ENCODING 0
+#define VARINT_ENCODING 1
+
+#define SIGNAL_FILE_VERSION 1
+#define SIGNAL_HEADER_SIZE 24
+#define SIGNAL_FLAG_LEVEL 1
+#define SIGNAL_FLAG_INDEX 2
+
+class SignalFile {
+private:
+  void *data;
+  std::size_t size;
+public:
+  explicit SignalFile(const std::string &path);
+  ~SignalFile();
+  SignalFile(const SignalFile &other) = delete;
+  SignalFile &operator =(const SignalFile &other) = delete;
+
+  std::size_t getSize() const;
+  BinarySignalView view(bool validate = true) const;
+};
+
+}
+
+#endif //SIGNAL_FILE_H
@@ -0,0 +1,69 @@
+#ifndef SIGNAL_ROPE_H
+#define SIGNAL_ROPE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BinarySignal.h"
+
+namespace lab2{
+
+#define ROPE_CHUNK_RUNS 256
+
+class SignalRope {
+private:
+  struct Chunk {
+    bool level;
+    std::int64_t total;
+    std::vector<std::int64_t> times;
+    Chunk(bool level, const std::int64_t *times, std::size_t n);
+  };
+  using ChunkPtr = std::shared_ptr<const Chunk>;
+  struct Node;
+  using NodePtr = std::shared_ptr<const Node>;
+  struct Node {
+    ChunkPtr chunk;
+    std::int64_t runs;
+    std::int64_t total;
+    NodePtr left;
+    NodePtr right;
+    Node(ChunkPtr chunk, NodePtr left, NodePtr right);
+  };
+  NodePtr root;
+
+  explicit SignalRope(NodePtr root) : root(std::move(root)) {}
+  static std::int64_t runsOf(const NodePtr &node);
+  static std::int64_t totalOf(const NodePtr &node);
+  static NodePtr leaf(bool level, const std::int64_t *times, std::size_t n);
+  static NodePtr build(const std::vector<ChunkPtr> &chunks, std::size_t from, std::size_t to);
+  static NodePtr merge(const NodePtr &left, const NodePtr &right);
+  static NodePtr join(const NodePtr &left, const NodePtr &right);
+  static void splitRuns(const NodePtr &node, std::int64_t runs, NodePtr &left, NodePtr &right);
+  static void splitTime(const NodePtr &node, std::int64_t time, NodePtr &left, NodePtr &right);
+  template <class Visit>
+  static void forEach(const NodePtr &node, Visit &visit);
+public:
+  SignalRope() = default;
+  explicit SignalRope(const BinarySignal &signal);
+
+  std::int64_t getCount() const;
+  SignalState getState(std::int64_t index) const;
+  std::int64_t runIndexAt(std::int64_t time) const;
+  std::int64_t totalTime() const;
+  bool operator [](std::int64_t time) const;
+
+  SignalRope &operator +=(const SignalRope &other);
+  SignalRope &insertSignal(const SignalRope &other, std::int64_t time);
+  SignalRope &removeSignal(std::int64_t time, std::int64_t duration);
+  SignalRope slice(std::int64_t time, std::int64_t duration) const;
+
+  BinarySignal toSignal() const;
+  std::string toString() const;
+  void write(std::ostream &output) const;
+};
+
+}
+
+#endif //SIGNAL_ROPE_H
@@ -1,12 +1,14 @@
 #ifndef SIGNAL_STATE_H
 #define SIGNAL_STATE_H
 
+#include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <limits>
 #include <string>
 #include <vector>
 
+#include "CheckedMath.h"
 #include "GetNum.h"
 
 namespace lab2{
@@ -23,24 +25,24 @@ class SignalState {
   friend std::istream &operator >>(std::istream &input, SignalState &signal);
 private:
   bool level;
-  int time;
+  std::int64_t time;
 public:
   SignalState() : level(0), time(0) {}
-  SignalState(int level, int time);
+  SignalState(int level, std::int64_t time);
   SignalState(const std::string &signal);
-  SignalState(std::vector<int> &signal);
+  SignalState(const std::vector<int> &signal);
   SignalState(const SignalState &other);
   SignalState &operator =(const SignalState &other);
   SignalState operator ~();
 
   bool getLevel() const;
-  int getTime() const;
+  std::int64_t getTime() const;
   void setLevel(bool level);
-  void setTime(int time);
+  void setTime(std::int64_t time);
   
   void invertSignal();
-  void elongateSignal(int duration);
-  void truncateSignal(int duration);
+  void elongateSignal(std::int64_t duration);
+  void truncateSignal(std::int64_t duration);
   std::string formatSignal() const;
 };
   
@@ -0,0 +1,56 @@
+#ifndef SIGNAL_STATS_H
+#define SIGNAL_STATS_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "BinarySignalView.h"
+
+namespace lab2{
+
+#define PULSE_HISTOGRAM_SIZE 64
+
+struct PulseWidths {
+  std::int64_t count = 0;
+  std::int64_t total = 0;
+  std::int64_t min = 0;
+  std::int64_t max = 0;
+  std::array<std::int64_t, PULSE_HISTOGRAM_SIZE> histogram = {};
+
+  void add(std::int64_t width);
+  void merge(const PulseWidths &other);
+  double mean() const;
+};
+
+class SignalStats {
+private:
+  std::int64_t runs;
+  bool first_level;
+  std::int64_t first_time;
+  bool last_level;
+  std::int64_t last_time;
+  std::int64_t high_time;
+  std::int64_t low_time;
+  PulseWidths high;
+  PulseWidths low;
+  void addPulse(bool level, std::int64_t width);
+public:
+  SignalStats();
+  explicit SignalStats(const BinarySignalView &view);
+
+  static std::vector<SignalStats> windows(const BinarySignalView &view, std::int64_t window, std::int64_t step);
+
+  std::int64_t getRunCount() const;
+  std::int64_t getHighTime() const;
+  std::int64_t getLowTime() const;
+  std::int64_t totalTime() const;
+  double dutyCycle() const;
+  const PulseWidths &pulses(bool level) const;
+
+  SignalStats &operator +=(const SignalStats &other);
+};
+
+}
+
+#endif //SIGNAL_STATS_H
@@ -1,107 +1,1266 @@
 
+#include <algorithm>
+#include <bit>
+#include <cstdint>
 #include <iostream>
+#include <utility>
 
 #include "BinarySignal.h"
+#include "Parallel.h"
+#include "RenderSink.h"
+#include "RepeatedSignal.h"
+#include "SampleScan.h"
 
 namespace lab2{
 
+  namespace {
+
+    const std::uint64_t BYTE_ONES = 0x0101010101010101ULL;
+
+    const std::uint64_t LOAD_RESERVE_RUNS = 1 << 16;
+
+/**
+ * @brief Loads 8 characters as a little-endian machine word.
+ */
+    std::uint64_t loadWord(const char *data){
+      std::uint64_t word;
+      std::memcpy(&word, data, sizeof(word));
+      return word;
+    }
+
+/**
+ * @brief Validates a '0'/'1' string and counts the runs in it.
+ * 
+ * Eight characters are processed per step: every byte is mapped to 0 or 1 and the word
+ * is compared with itself shifted by one character, so each transition leaves exactly
+ * one set bit.
+ *
+ * @param str The string to check.
+ * @return The number of runs in the string.
+ * @throw std::invalid_argument if the string contains characters other than '0' and '1'.
+ */
+    int countRuns(std::string_view str){
+      const char *data = str.data();
+      std::size_t length = str.length();
+      if (length == 0){
+        return 0;
+      }
+      std::size_t i = 0;
+      int transitions = 0;
+      if constexpr (std::endian::native == std::endian::little){
+        for (; i + 9 <= length; i += 8){
+          std::uint64_t word = loadWord(data + i) ^ (BYTE_ONES * '0');
+          if (word & ~BYTE_ONES){
+            throw std::invalid_argument("error: invalid characters in string");
+          }
+          std::uint64_t next = loadWord(data + i + 1) ^ (BYTE_ONES * '0');
+          transitions += std::popcount((word ^ next) & BYTE_ONES);
+        }
+      }
+      for (; i < length; i++){
+        if (data[i] != '0' && data[i] != '1'){
+          throw std::invalid_argument("error: invalid characters in string");
+        }
+        if (i + 1 < length && data[i] != data[i + 1]){
+          transitions++;
+        }
+      }
+      return transitions + 1;
+    }
+
+/**
+ * @brief Finds the first character that differs from the given one.
+ * 
+ * Eight characters are compared per step, the position inside the word is taken
+ * from the number of trailing zero bits of the difference.
+ *
+ * @param str The string to scan.
+ * @param from The position to start from.
+ * @param current The character of the current run.
+ * @return The position of the first different character or the length of the string.
+ */
+    std::size_t findTransition(std::string_view str, std::size_t from, char current){
+      const char *data = str.data();
+      std::size_t length = str.length();
+      std::size_t i = from;
+      if constexpr (std::endian::native == std::endian::little){
+        for (; i + 8 <= length; i += 8){
+          std::uint64_t diff = loadWord(data + i) ^ (BYTE_ONES * (unsigned char)current);
+          if (diff){
+            return i + std::countr_zero(diff) / 8;
+          }
+        }
+      }
+      while (i < length && data[i] == current){
+        i++;
+      }
+      return i;
+    }
+
+/**
+ * @brief Multiplies a time by num / den rounding half up.
+ */
+    std::int64_t scaleRounded(std::int64_t time, std::int64_t num, std::int64_t den){
+      std::int64_t scaled = checkedMul(time, num);
+      std::int64_t result = scaled / den;
+      std::int64_t rest = scaled % den;
+      return (rest >= den - rest) ? result + 1 : result;
+    }
+
+/**
+ * @brief Stores an unsigned integer of the given width in little-endian byte order.
+ */
+    void storeLittleEndian(unsigned char *data, std::uint64_t value, int width){
+      for (int i = 0; i < width; i++){
+        data[i] = (unsigned char)(value >> (8 * i));
+      }
+    }
+
+/**
+ * @brief Buffered byte output for BinarySignal::save().
+ */
+    class ByteWriter {
+    public:
+      explicit ByteWriter(std::ostream &output) : output(output), used(0) {}
+      void put(unsigned char byte){
+        if (used == sizeof(buffer)){
+          flush();
+        }
+        buffer[used++] = byte;
+      }
+      void putFixed(std::uint64_t value){
+        for (int i = 0; i < 8; i++){
+          put((unsigned char)(value >> (8 * i)));
+        }
+      }
+      void putVarint(std::uint64_t value){
+        while (value >= 0x80){
+          put((unsigned char)(value | 0x80));
+          value >>= 7;
+        }
+        put((unsigned char)value);
+      }
+      void flush(){
+        output.write(reinterpret_cast<const char *>(buffer), used);
+        used = 0;
+      }
+    private:
+      std::ostream &output;
+      unsigned char buffer[65536];
+      std::size_t used;
+    };
+
+/**
+ * @brief Byte input for BinarySignal::load().
+ *
+ * Reads through the stream buffer, which does its own buffering, so exactly
+ * the bytes of the signal are consumed and the data after it stays in the stream.
+ */
+    class ByteReader {
+    public:
+      explicit ByteReader(std::istream &input) : input(input), source(nullptr) {
+        std::istream::sentry sentry(input, true);
+        if (!sentry || !input.rdbuf()){
+          throw std::runtime_error("failed to read signal: unexpected end of data");
+        }
+        source = input.rdbuf();
+      }
+      unsigned char get(){
+        std::streambuf::int_type byte = source->sbumpc();
+        if (std::streambuf::traits_type::eq_int_type(byte, std::streambuf::traits_type::eof())){
+          input.setstate(std::ios::eofbit | std::ios::failbit);
+          throw std::runtime_error("failed to read signal: unexpected end of data");
+        }
+        return (unsigned char)std::streambuf::traits_type::to_char_type(byte);
+      }
+      std::uint64_t getFixed(){
+        std::uint64_t value = 0;
+        for (int i = 0; i < 8; i++){
+          value |= (std::uint64_t)get() << (8 * i);
+        }
+        return value;
+      }
+      std::uint64_t getVarint(){
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7){
+          unsigned char byte = get();
+          value |= (std::uint64_t)(byte & 0x7F) << shift;
+          if (!(byte & 0x80)){
+            return value;
+          }
+        }
+        throw std::invalid_argument("error: invalid signal file");
+      }
+    private:
+      std::istream &input;
+      std::streambuf *source;
+    };
+
+  }
+
   //BinarySignal::BinarySignal() : count(1), signal(new SignalState[this->count]) {}
 
 /**
- * @brief Constructs a BinarySignal with the specified initial level and time.
+ * @brief Constructs a BinarySignal with the specified initial level and time.
+ * 
+ * This constructor initializes a BinarySignal with the given level and time.
+ *
+ * @param level The initial level (0 or 1) for the BinarySignal.
+ * @param time The initial time (duration) for the BinarySignal.
+ * @throw std::invalid_argument if the provided signal state is invalid.
+ */
+  BinarySignal::BinarySignal(int level, std::int64_t time): level(level == 1), count(0), capacity(0), total(time), times(nullptr), ends(nullptr), refs(nullptr) {
+    if ((level < 0 || level > 1) || time <= 0){
+      throw std::invalid_argument("error: invalid signal state");
+    }
+    reserve(1);
+    times[0] = time;
+    count = 1;
+  }
+
+/**
+ * @brief Constructs a BinarySignal from a string representation.
+ * 
+ * This constructor creates a BinarySignal based on a string representation of the signal, where '0' and '1' represent level changes.
+ * The string is validated and its runs are counted in one word-at-a-time pass, then the storage
+ * is allocated once and filled in a second pass. Long strings are split into chunks processed in parallel.
+ *
+ * @param signal_str A string containing '0' and '1' characters to represent the signal.
+ * @throw std::invalid_argument if the provided string contains invalid characters or has an invalid format.
+ */
+  BinarySignal::BinarySignal(std::string_view signal_str) : level(false), count(0), capacity(0), total(0), times(nullptr), ends(nullptr), refs(nullptr) {
+    encodeRuns(signal_str.length(),
+      [signal_str](std::size_t begin, std::size_t end){ return (std::size_t)countRuns(signal_str.substr(begin, end - begin)) - 1; },
+      [signal_str](std::size_t end, std::size_t from, bool level){ return findTransition(signal_str.substr(0, end), from, level ? '1' : '0'); },
+      [signal_str](std::size_t position){ return signal_str[position] == '1'; });
+  }
+
+/**
+ * @brief Fills an empty BinarySignal with the runs of a sample buffer.
+ * 
+ * The buffer is split into parallelChunks() chunks aligned to 64 samples. The transitions of every
+ * chunk are counted in parallel, an exclusive scan of the counts gives the first run of every chunk,
+ * so the storage is allocated once and every chunk writes the end positions of its runs in parallel.
+ * A last parallel pass turns the end positions into durations. With one chunk this is the serial path.
+ *
+ * @param length The number of samples.
+ * @param count_chunk Callable (begin, end) returning the number of level changes between neighbouring samples in [begin, end).
+ * @param find Callable (end, from, level) returning the first position in [from, end) with a level other than level, or end.
+ * @param level_at Callable (position) returning the level of a sample.
+ * @throw std::invalid_argument if the buffer has more runs than a BinarySignal can hold.
+ */
+  template <class Count, class Find, class Level>
+  void BinarySignal::encodeRuns(std::size_t length, Count count_chunk, Find find, Level level_at){
+    if (length == 0){
+      return;
+    }
+    std::size_t chunks = parallelChunks(length);
+    std::vector<std::size_t> bounds(chunks + 1);
+    for (std::size_t k = 0; k < chunks; k++){
+      bounds[k] = (length / chunks * k) & ~(std::size_t)63;
+    }
+    bounds[chunks] = length;
+    std::vector<std::size_t> first(chunks + 1);
+    parallelFor(chunks, [&](std::size_t k){
+      std::size_t begin = bounds[k];
+      first[k + 1] = count_chunk(begin, bounds[k + 1]) + (k > 0 && level_at(begin - 1) != level_at(begin));
+    });
+    for (std::size_t k = 0; k < chunks; k++){
+      first[k + 1] += first[k];
+    }
+    std::size_t transitions = first[chunks];
+    if (transitions >= (std::size_t)std::numeric_limits<int>::max()){
+      throw std::invalid_argument("error: signal is too long");
+    }
+    reserve((int)transitions + 1);
+    std::int64_t *out = times;
+    parallelFor(chunks, [&](std::size_t k){
+      std::size_t begin = bounds[k], end = bounds[k + 1], index = first[k];
+      bool current_level = level_at(begin);
+      if (k > 0 && level_at(begin - 1) != current_level){
+        out[index++] = (std::int64_t)begin;
+      }
+      for (std::size_t position = find(end, begin + 1, current_level); position < end; position = find(end, position + 1, current_level)){
+        out[index++] = (std::int64_t)position;
+        current_level = !current_level;
+      }
+    });
+    out[transitions] = (std::int64_t)length;
+    first[chunks] = transitions + 1;
+    std::vector<std::int64_t> previous(chunks);
+    for (std::size_t k = 0; k < chunks; k++){
+      previous[k] = (first[k] != 0) ? out[first[k] - 1] : 0;
+    }
+    parallelFor(chunks, [&](std::size_t k){
+      for (std::size_t i = first[k + 1]; i-- > first[k] + 1;){
+        out[i] -= out[i - 1];
+      }
+      if (first[k] < first[k + 1]){
+        out[first[k]] -= previous[k];
+      }
+    });
+    this->level = level_at(0);
+    this->count = (int)transitions + 1;
+    this->total = (std::int64_t)length;
+  }
+
+/**
+ * @brief Constructs a BinarySignal from a buffer of byte samples.
+ * 
+ * Every non-zero sample is a high level. Level transitions are found by the SIMD kernels
+ * from SampleScan.h, chosen at runtime according to the processor features.
+ * Long buffers are split into chunks processed in parallel.
+ *
+ * @param samples The samples, one per time unit.
+ */
+  BinarySignal::BinarySignal(std::span<const std::uint8_t> samples) : level(false), count(0), capacity(0), total(0), times(nullptr), ends(nullptr), refs(nullptr) {
+    const std::uint8_t *data = samples.data();
+    encodeRuns(samples.size(),
+      [data](std::size_t begin, std::size_t end){ return countByteTransitions(data + begin, end - begin); },
+      [data](std::size_t end, std::size_t from, bool level){ return findByteTransition(data, end, from, level); },
+      [data](std::size_t position){ return data[position] != 0; });
+  }
+
+/**
+ * @brief Constructs a BinarySignal from a buffer of int samples.
+ * 
+ * Every non-zero sample is a high level. Level transitions are found by the SIMD kernels
+ * from SampleScan.h, chosen at runtime according to the processor features.
+ *
+ * @param samples The samples, one per time unit.
+ */
+  BinarySignal::BinarySignal(std::span<const int> samples) : level(false), count(0), capacity(0), total(0), times(nullptr), ends(nullptr), refs(nullptr) {
+    const int *data = samples.data();
+    encodeRuns(samples.size(),
+      [data](std::size_t begin, std::size_t end){ return countIntTransitions(data + begin, end - begin); },
+      [data](std::size_t end, std::size_t from, bool level){ return findIntTransition(data, end, from, level); },
+      [data](std::size_t position){ return data[position] != 0; });
+  }
+
+/**
+ * @brief Constructs a BinarySignal from a packed bitset.
+ * 
+ * Sample i is bit i % 64 of bits[i / 64]. The bitset is scanned a whole word at a time.
+ *
+ * @param bits The packed samples.
+ * @param bit_count The number of samples stored in bits.
+ * @throw std::invalid_argument if bit_count exceeds the number of bits in the buffer.
+ */
+  BinarySignal::BinarySignal(std::span<const std::uint64_t> bits, std::size_t bit_count) : level(false), count(0), capacity(0), total(0), times(nullptr), ends(nullptr), refs(nullptr) {
+    if (bit_count > bits.size() * 64){
+      throw std::invalid_argument("error: invalid bit count");
+    }
+    const std::uint64_t *data = bits.data();
+    encodeRuns(bit_count,
+      [data](std::size_t begin, std::size_t end){ return countBitTransitions(data + begin / 64, end - begin); },
+      [data](std::size_t end, std::size_t from, bool level){ return findBitTransition(data, end, from, level); },
+      [data](std::size_t position){ return ((data[position / 64] >> (position % 64)) & 1) != 0; });
+  }
+
+/**
+ * @brief Creates a BinarySignal from a buffer of byte samples.
+ * 
+ * @param samples The samples, one per time unit; every non-zero sample is a high level.
+ * @return The run-length encoded BinarySignal.
+ */
+  BinarySignal BinarySignal::fromSamples(std::span<const std::uint8_t> samples){
+    return BinarySignal(samples);
+  }
+
+/**
+ * @brief Creates a BinarySignal from a buffer of int samples.
+ * 
+ * @param samples The samples, one per time unit; every non-zero sample is a high level.
+ * @return The run-length encoded BinarySignal.
+ */
+  BinarySignal BinarySignal::fromSamples(std::span<const int> samples){
+    return BinarySignal(samples);
+  }
+
+/**
+ * @brief Creates a BinarySignal from a packed bitset.
+ * 
+ * @param bits The packed samples, sample i is bit i % 64 of bits[i / 64].
+ * @param bit_count The number of samples stored in bits.
+ * @return The run-length encoded BinarySignal.
+ * @throw std::invalid_argument if bit_count exceeds the number of bits in the buffer.
+ */
+  BinarySignal BinarySignal::fromSamples(std::span<const std::uint64_t> bits, std::size_t bit_count){
+    return BinarySignal(bits, bit_count);
+  }
+
+/**
+ * @brief Constructs a BinarySignal by copying the runs of a BinarySignalView.
+ * 
+ * @param view The view to copy, e.g. over a mapped signal file.
+ * @throw std::overflow_error if the total time of the view does not fit the time type.
+ */
+  BinarySignal::BinarySignal(const BinarySignalView &view) : level(false), count(0), capacity(0), total(0), times(nullptr), ends(nullptr), refs(nullptr) {
+    reserve(view.getCount());
+    for (int i = 0; i < view.getCount(); i++){
+      SignalState state = view.getState(i);
+      pushRun(state.level, state.time);
+    }
+  }
+
+/**
+ * @brief Reads a BinarySignal saved by save().
+ * 
+ * Both encodings are accepted, the saved time index is skipped and rebuilt on demand.
+ * Only the bytes of the signal are consumed, so several signals can be read from one stream.
+ * The run count in the header is not trusted for allocation: at most LOAD_RESERVE_RUNS runs
+ * are reserved up front and the storage grows as the runs are decoded.
+ *
+ * @param input The stream to read from.
+ * @return The loaded BinarySignal.
+ * @throw std::invalid_argument if the data is not a valid signal.
+ * @throw std::runtime_error if the stream ends too early.
+ */
+  BinarySignal BinarySignal::load(std::istream &input){
+    ByteReader reader(input);
+    unsigned char header[SIGNAL_HEADER_SIZE];
+    for (int i = 0; i < SIGNAL_HEADER_SIZE; i++){
+      header[i] = reader.get();
+    }
+    if (std::memcmp(header, "BSIG", 4) != 0){
+      throw std::invalid_argument("error: invalid signal file");
+    }
+    if ((header[4] | header[5] << 8) != SIGNAL_FILE_VERSION){
+      throw std::invalid_argument("error: unsupported signal file version");
+    }
+    int encoding = header[6];
+    bool level = header[7] & SIGNAL_FLAG_LEVEL;
+    std::uint64_t runs = 0;
+    std::uint64_t total = 0;
+    for (int i = 7; i >= 0; i--){
+      runs = (runs << 8) | header[8 + i];
+      total = (total << 8) | header[16 + i];
+    }
+    if ((encoding != FIXED_ENCODING && encoding != VARINT_ENCODING) || runs > (std::uint64_t)std::numeric_limits<int>::max()){
+      throw std::invalid_argument("error: invalid signal file");
+    }
+
+    BinarySignal result;
+    result.reserve((int)std::min<std::uint64_t>(runs, LOAD_RESERVE_RUNS));
+    result.level = level;
+    for (std::uint64_t i = 0; i < runs; i++){
+      std::uint64_t time = (encoding == FIXED_ENCODING) ? reader.getFixed() : reader.getVarint();
+      if (time == 0 || time > (std::uint64_t)std::numeric_limits<std::int64_t>::max()){
+        throw std::invalid_argument("error: invalid signal file");
+      }
+      if (result.count == result.capacity){
+        result.grow(result.count + 1);
+      }
+      result.times[result.count] = (std::int64_t)time;
+      result.count++;
+      result.total = checkedAdd(result.total, (std::int64_t)time);
+    }
+    if ((std::uint64_t)result.total != total){
+      throw std::invalid_argument("error: invalid signal file");
+    }
+    if (header[7] & SIGNAL_FLAG_INDEX){
+      for (std::uint64_t i = 0; i < runs; i++){
+        reader.getFixed();
+      }
+    }
+    return result;
+  }
+
+/**
+ * @brief Writes the BinarySignal in the binary signal format.
+ * 
+ * The 24-byte header holds the magic "BSIG", the format version, the encoding, the flags
+ * (initial level and time index), the number of runs and the total time, all little-endian.
+ * It is followed by the run lengths, as 64-bit integers for FIXED_ENCODING or as LEB128 varints
+ * for VARINT_ENCODING. Levels are not stored since they alternate in the canonical form.
+ * With time_index the cumulative run end times follow as 64-bit integers, so that a
+ * BinarySignalView over the data can look up times in O(log n).
+ *
+ * @param output The stream to write to.
+ * @param encoding FIXED_ENCODING or VARINT_ENCODING.
+ * @param time_index true to store the cumulative time index, requires FIXED_ENCODING.
+ * @throw std::invalid_argument if the encoding is invalid or does not support the time index.
+ */
+  void BinarySignal::save(std::ostream &output, int encoding, bool time_index) const{
+    if ((encoding != FIXED_ENCODING && encoding != VARINT_ENCODING) || (time_index && encoding != FIXED_ENCODING)){
+      throw std::invalid_argument("error: invalid signal encoding");
+    }
+    unsigned char header[SIGNAL_HEADER_SIZE];
+    std::memcpy(header, "BSIG", 4);
+    storeLittleEndian(header + 4, SIGNAL_FILE_VERSION, 2);
+    header[6] = (unsigned char)encoding;
+    header[7] = (count != 0 && level ? SIGNAL_FLAG_LEVEL : 0) | (time_index ? SIGNAL_FLAG_INDEX : 0);
+    storeLittleEndian(header + 8, count, 8);
+    storeLittleEndian(header + 16, totalTime(), 8);
+
+    ByteWriter writer(output);
+    for (int i = 0; i < SIGNAL_HEADER_SIZE; i++){
+      writer.put(header[i]);
+    }
+    for (int i = 0; i < count; i++){
+      if (encoding == FIXED_ENCODING){
+        writer.putFixed(times[i]);
+      }
+      else{
+        writer.putVarint(times[i]);
+      }
+    }
+    if (time_index){
+      std::uint64_t sum_time = 0;
+      for (int i = 0; i < count; i++){
+        sum_time += times[i];
+        writer.putFixed(sum_time);
+      }
+    }
+    writer.flush();
+  }
+
+/**
+ * @brief Constructs a BinarySignal by copying the content of another BinarySignal.
+ * 
+ * The copy shares the run storage and the time index with the original in O(1).
+ * The storage is reference counted, the first mutation of either signal clones it.
+ *
+ * @param other The BinarySignal to copy.
+ */
+  BinarySignal::BinarySignal(const BinarySignal& other) : level(other.level), count(other.count), capacity(other.capacity),
+    total(other.total), times(other.times), ends(other.ends), refs(other.refs) {
+    if (refs){
+      refs->fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+/**
+ * @brief Move constructor for BinarySignal.
+ * 
+ * This constructor transfers ownership of the signal data from the source BinarySignal to the new BinarySignal.
+ *
+ * @param other The BinarySignal to move from.
+ */
+  BinarySignal::BinarySignal(BinarySignal&& other) noexcept : level(other.level), count(other.count), capacity(other.capacity),
+    total(other.total), times(other.times), ends(other.ends), refs(other.refs) {
+    other.count = 0;
+    other.total = 0;
+    other.capacity = 0;
+    other.times = nullptr;
+    other.ends = nullptr;
+    other.refs = nullptr;
+  }
+
+/**
+ * @brief Get the count of SignalState elements in the BinarySignal.
+ * 
+ * @return The number of SignalState elements in the BinarySignal.
+ */
+  int BinarySignal::getCount() const {
+    return count;
+  }
+
+/**
+ * @brief Get the run with the given index.
+ * 
+ * @param index The index of the run.
+ * @return The run as a SignalState.
+ * @throw std::invalid_argument if the index is out of range.
+ */
+  SignalState BinarySignal::getState(int index) const {
+    if (index < 0 || index >= count){
+      throw std::invalid_argument("error: invalid index");
+    }
+    return SignalState(runLevel(index), times[index]);
+  }
+
+/**
+ * @brief Get the number of runs the BinarySignal can hold without reallocation.
+ * 
+ * Every run takes 8 bytes, and 8 more while the time index is built.
+ *
+ * @return The capacity of the BinarySignal storage.
+ */
+  int BinarySignal::getCapacity() const {
+    return capacity;
+  }
+
+/**
+ * @brief Ensures the storage can hold at least new_capacity runs.
+ * 
+ * If new_capacity does not exceed the current capacity, nothing happens.
+ * Otherwise the storage is reallocated and the existing elements are moved into it.
+ *
+ * @param new_capacity The minimal number of runs to hold without reallocation.
+ * @throw std::invalid_argument if new_capacity is negative.
+ */
+  void BinarySignal::reserve(int new_capacity){
+    if (new_capacity < 0){
+      throw std::invalid_argument("error: invalid capacity");
+    }
+    if (new_capacity <= capacity){
+      return;
+    }
+    reallocate(new_capacity);
+  }
+
+/**
+ * @brief Releases the unused part of the storage.
+ * 
+ * After the call the capacity equals the number of runs.
+ */
+  void BinarySignal::shrinkToFit(){
+    if (capacity == count){
+      return;
+    }
+    reallocate(count);
+  }
+
+/**
+ * @brief Moves the runs and the time index into new storage owned only by this signal.
+ * 
+ * The previous storage is released, it is freed when no other copy refers to it.
+ *
+ * @param new_capacity The capacity of the new storage, not less than the number of runs.
+ */
+  void BinarySignal::reallocate(int new_capacity){
+    std::int64_t *result = (new_capacity != 0) ? new std::int64_t[new_capacity] : nullptr;
+    std::copy(times, times + count, result);
+    std::int64_t *result_ends = nullptr;
+    if (ends){
+      result_ends = new std::int64_t[new_capacity ? new_capacity : 1];
+      std::copy(ends, ends + count, result_ends);
+    }
+    std::atomic<int> *result_refs = new std::atomic<int>(1);
+    release();
+    this->times = result;
+    this->ends = result_ends;
+    this->refs = result_refs;
+    this->capacity = new_capacity;
+  }
+
+/**
+ * @brief Drops the reference to the storage and frees it if this was the last one.
+ * 
+ * The pointers are reset, the number of runs is left to the caller.
+ */
+  void BinarySignal::release(){
+    if (refs && refs->fetch_sub(1, std::memory_order_acq_rel) == 1){
+      delete[] times;
+      delete[] ends;
+      delete refs;
+    }
+    this->times = nullptr;
+    this->ends = nullptr;
+    this->refs = nullptr;
+  }
+
+/**
+ * @brief Clones the storage if it is shared with another copy.
+ * 
+ * Must be called before any write to the runs or the time index.
+ */
+  void BinarySignal::detach(){
+    if (refs && refs->load(std::memory_order_acquire) > 1){
+      reallocate(capacity);
+    }
+  }
+
+/**
+ * @brief Creates a non-owning view over the runs of the signal.
+ * 
+ * The view uses the time index if it is present. It is valid until the signal is modified or destroyed.
+ *
+ * @return The view.
+ */
+  BinarySignalView BinarySignal::view() const{
+    return BinarySignalView(level, count, times, ends, total);
+  }
+
+/**
+ * @brief Creates a non-owning view over a time interval of the signal.
+ * 
+ * Only the boundary runs are located, in O(log n) with the time index, nothing is copied.
+ * The view is valid until the signal is modified or destroyed.
+ *
+ * @param time The start of the interval.
+ * @param duration The duration of the interval.
+ * @return The view over the interval.
+ * @throw std::invalid_argument if the interval is not inside the signal.
+ */
+  BinarySignalView BinarySignal::slice(std::int64_t time, std::int64_t duration) const{
+    return view().slice(time, duration);
+  }
+
+/**
+ * @brief Get a random-access iterator to the first run.
+ * 
+ * The iterators are valid until the signal is modified or destroyed.
+ *
+ * @return The iterator.
+ */
+  RunIterator BinarySignal::begin() const{
+    return view().begin();
+  }
+
+/**
+ * @brief Get an iterator past the last run.
+ * 
+ * @return The iterator.
+ */
+  RunIterator BinarySignal::end() const{
+    return view().end();
+  }
+
+/**
+ * @brief Get the range of levels of the signal, one per time unit.
+ * 
+ * The levels are produced by walking the runs, the signal is not expanded.
+ * The range is valid until the signal is modified or destroyed.
+ *
+ * @return The range of levels.
+ */
+  SampleRange BinarySignal::samples() const{
+    return view().samples();
+  }
+
+/**
+ * @brief Get the range of level changes of the signal.
+ * 
+ * The edges are produced lazily from the runs in O(runs), the signal is not rendered.
+ * The range is valid until the signal is modified or destroyed.
+ *
+ * @return The range of edges ordered by time.
+ */
+  EdgeRange BinarySignal::edges() const{
+    return view().edges();
+  }
+
+/**
+ * @brief Get the range of rising edges of the signal.
+ * 
+ * @return The range of edges ordered by time.
+ */
+  EdgeRange BinarySignal::risingEdges() const{
+    return view().risingEdges();
+  }
+
+/**
+ * @brief Get the range of falling edges of the signal.
+ * 
+ * @return The range of edges ordered by time.
+ */
+  EdgeRange BinarySignal::fallingEdges() const{
+    return view().fallingEdges();
+  }
+
+/**
+ * @brief Writes the level changes of the signal into a buffer.
+ * 
+ * @param buffer The buffer to fill, the edges that do not fit are skipped.
+ * @param kind EDGE_ANY, EDGE_RISING or EDGE_FALLING.
+ * @return The number of edges written.
+ * @throw std::invalid_argument if kind is not a valid edge kind.
+ */
+  std::size_t BinarySignal::copyEdges(std::span<Edge> buffer, int kind) const{
+    return view().copyEdges(buffer, kind);
+  }
+
+/**
+ * @brief Checks whether the storage is shared with another copy.
+ * 
+ * @return true if the next mutation clones the storage.
+ */
+  bool BinarySignal::isShared() const{
+    return refs && refs->load(std::memory_order_acquire) > 1;
+  }
+
+/**
+ * @brief Grows the storage geometrically so that it can hold at least min_capacity elements.
+ * 
+ * The capacity is doubled on every growth, which makes a sequence of appends
+ * cost amortized O(1) per element.
+ *
+ * @param min_capacity The minimal number of elements to hold after the call.
+ */
+  void BinarySignal::grow(int min_capacity){
+    int new_capacity = (capacity < 4) ? 4 : (capacity > std::numeric_limits<int>::max() / 2) ? std::numeric_limits<int>::max() : capacity * 2;
+    if (new_capacity < min_capacity){
+      new_capacity = min_capacity;
+    }
+    reserve(new_capacity);
+  }
+
+/**
+ * @brief Get the level of the run with the given index.
+ * 
+ * Levels alternate in the canonical form, so only the level of the first run is stored.
+ *
+ * @param index The index of the run.
+ * @return The level of the run.
+ */
+  bool BinarySignal::runLevel(int index) const {
+    return level != (index % 2 != 0);
+  }
+
+/**
+ * @brief Appends a single run to the end of the storage keeping the canonical form.
+ * 
+ * A run with zero time is ignored. A run with the same level as the last run
+ * is merged into it instead of being stored separately.
+ *
+ * @param run_level The level of the run.
+ * @param time The duration of the run.
+ * @throw std::overflow_error if the total time does not fit the time type.
+ */
+  void BinarySignal::pushRun(bool run_level, std::int64_t time){
+    if (time == 0){
+      return;
+    }
+    std::int64_t new_total = checkedAdd(total, time);
+    detach();
+    total = new_total;
+    if (count == 0){
+      this->level = run_level;
+    }
+    else if (runLevel(count - 1) == run_level){
+      times[count - 1] += time;
+      updateIndex(count - 1);
+      return;
+    }
+    if (count == capacity){
+      grow(count + 1);
+    }
+    times[count] = time;
+    count++;
+    updateIndex(count - 1);
+  }
+
+/**
+ * @brief Appends n canonical runs to the end of the storage.
+ * 
+ * The first run goes through pushRun() so that it is merged with the last run
+ * when their levels are equal; the rest are copied in bulk.
+ * The time index, if present, is extended incrementally.
+ *
+ * @param first_level The level of the first appended run, the following ones alternate.
+ * @param runs Pointer to the durations to append, must not point into this signal.
+ * @param n The number of runs to append.
+ * @throw std::overflow_error if the total time does not fit the time type; the signal is left unchanged.
+ */
+  void BinarySignal::appendRuns(bool first_level, const std::int64_t *runs, int n){
+    if (n <= 0){
+      return;
+    }
+    std::int64_t sum_time = 0;
+    for (int i = 1; i < n; i++){
+      sum_time = checkedAdd(sum_time, runs[i]);
+    }
+    checkedAdd(checkedAdd(total, runs[0]), sum_time);
+    detach();
+    pushRun(first_level, runs[0]);
+    if (n == 1){
+      return;
+    }
+    if (capacity < count + n - 1){
+      grow(count + n - 1);
+    }
+    std::copy(runs + 1, runs + n, this->times + count);
+    total += sum_time;
+    int from = count;
+    this->count = count + n - 1;
+    updateIndex(from);
+  }
+
+/**
+ * @brief Brings the BinarySignal to the canonical form.
+ * 
+ * Runs with zero time are removed and the runs around them, which then have equal levels,
+ * are merged, in place and in a single pass. Every mutating operation keeps the canonical form,
+ * so this is only needed for signals assembled by other means.
+ */
+  void BinarySignal::normalize(){
+    detach();
+    int j = 0;
+    bool first_level = level;
+    for (int i = 0; i < count; i++){
+      if (times[i] == 0){
+        continue;
+      }
+      if (j == 0){
+        first_level = runLevel(i);
+        times[j] = times[i];
+        j++;
+      }
+      else if ((first_level != ((j - 1) % 2 != 0)) == runLevel(i)){
+        times[j - 1] += times[i];
+      }
+      else{
+        times[j] = times[i];
+        j++;
+      }
+    }
+    level = first_level;
+    count = j;
+    updateIndex(0);
+  }
+
+/**
+ * @brief Removes glitches shorter than min_width.
+ * 
+ * Same as debounce(min_width, min_width).
+ *
+ * @param min_width The minimal duration of a run that is kept.
+ * @return A reference to the modified BinarySignal.
+ * @throw std::invalid_argument if min_width is negative.
+ */
+  BinarySignal &BinarySignal::debounce(std::int64_t min_width){
+    return debounce(min_width, min_width);
+  }
+
+/**
+ * @brief Removes glitches with separate thresholds for the two levels.
+ * 
+ * A change of level is accepted only if the new level lasts at least min_high time for a high
+ * run or min_low time for a low run; shorter runs are absorbed into the preceding level, which works
+ * as hysteresis when the thresholds differ. Short runs at the start have no preceding level and are
+ * absorbed into the first run that is long enough; if there is none, the signal keeps its first level.
+ * Done in place in a single O(runs) pass without reallocation, the result is canonical.
+ *
+ * @param min_high The minimal duration of a high run that is kept.
+ * @param min_low The minimal duration of a low run that is kept.
+ * @return A reference to the modified BinarySignal.
+ * @throw std::invalid_argument if a threshold is negative.
+ */
+  BinarySignal &BinarySignal::debounce(std::int64_t min_high, std::int64_t min_low){
+    if (min_high < 0 || min_low < 0){
+      throw std::invalid_argument("error: invalid time");
+    }
+    if (count < 2){
+      return *this;
+    }
+    detach();
+    bool first_level = level;
+    int first = 0;
+    while (first < count && times[first] < (runLevel(first) ? min_high : min_low)){
+      first++;
+    }
+    if (first == count){
+      first = 0;
+    }
+    std::int64_t leading = 0;
+    for (int i = 0; i < first; i++){
+      leading += times[i];
+    }
+    level = first_level != (first % 2 != 0);
+    times[0] = times[first] + leading;
+    int j = 1;
+    for (int i = first + 1; i < count; i++){
+      bool run_level = first_level != (i % 2 != 0);
+      if (runLevel(j - 1) == run_level || times[i] < (run_level ? min_high : min_low)){
+        times[j - 1] += times[i];
+      }
+      else{
+        times[j] = times[i];
+        j++;
+      }
+    }
+    count = j;
+    updateIndex(0);
+    return *this;
+  }
+
+/**
+ * @brief Checks that the BinarySignal is in the canonical form.
  * 
- * This constructor initializes a BinarySignal with the given level and time.
+ * Adjacent runs always have different levels since levels are derived from the run index,
+ * so it remains to check that there are no zero time runs.
  *
- * @param level The initial level (0 or 1) for the BinarySignal.
- * @param time The initial time (duration) for the BinarySignal.
- * @throw std::invalid_argument if the provided signal state is invalid.
+ * @return true if every run has a positive time.
  */
-  BinarySignal::BinarySignal(int level, int time): count(1), signal(new SignalState[this->count]) {
-    if (!(level < 0 || level > 1) && time > 0){
-      signal[0].time = time;
-      signal[0].level = level;
-    }
-    else{
-      delete [] this->signal;
-      throw std::invalid_argument("error: invalid signal state");
+  bool BinarySignal::isCanonical() const{
+    for (int i = 0; i < count; i++){
+      if (times[i] <= 0){
+        return false;
+      }
     }
+    return true;
   }
 
 /**
- * @brief Constructs a BinarySignal from a string representation.
+ * @brief Recomputes the cumulative time index starting from the given run.
  * 
- * This constructor creates a BinarySignal based on a string representation of the signal, where '0' and '1' represent level changes.
+ * ends[i] holds the total time of runs 0..i. Does nothing if the index is disabled.
+ * Short ranges, such as the single run touched by an append, are scanned serially without allocating.
+ * Long ranges are scanned in parallel chunks: the chunk sums are computed first, then every chunk is filled from its offset.
  *
- * @param signal_str A string containing '0' and '1' characters to represent the signal.
- * @throw std::invalid_argument if the provided string contains invalid characters or has an invalid format.
+ * @param from The first run whose cumulative time has to be recomputed.
  */
-  BinarySignal::BinarySignal(std::string signal_str){
-    if (signal_str.find_first_not_of("01") != std::string::npos){
-      throw std::invalid_argument("error: invalid characters in string");
+  void BinarySignal::updateIndex(int from){
+    if (!ends || from >= count){
+      return;
     }
-    else {
-      count = 0;
-      signal = nullptr;
-
-      for (int i = 0; i < (int)signal_str.length(); i++) {
-        char current_level = signal_str[i];
-        int current_time = 1;
-        while (i < (int)signal_str.length() - 1 && signal_str[i + 1] == current_level) {
-          current_time++;
-          i++;
+    std::size_t chunks = parallelChunks(count - from);
+    if (chunks == 1){
+      std::int64_t sum_time = (from > 0) ? ends[from - 1] : 0;
+      for (int i = from; i < count; i++){
+        sum_time += times[i];
+        ends[i] = sum_time;
+      }
+      return;
+    }
+    std::vector<std::int64_t> sums(chunks + 1, 0);
+    sums[0] = (from > 0) ? ends[from - 1] : 0;
+    auto bound = [from, chunks, this](std::size_t k){ return from + (int)((std::size_t)(count - from) * k / chunks); };
+    if (chunks > 1){
+      parallelFor(chunks, [&](std::size_t k){
+        std::int64_t sum_time = 0;
+        for (int i = bound(k); i < bound(k + 1); i++){
+          sum_time += times[i];
         }
-        *this += SignalState(bool(current_level - '0'), current_time);
+        sums[k + 1] = sum_time;
+      });
+      for (std::size_t k = 0; k < chunks; k++){
+        sums[k + 1] += sums[k];
       }
     }
+    parallelFor(chunks, [&](std::size_t k){
+      std::int64_t sum_time = sums[k];
+      for (int i = bound(k); i < bound(k + 1); i++){
+        sum_time += times[i];
+        ends[i] = sum_time;
+      }
+    });
   }
 
 /**
- * @brief Constructs a BinarySignal by copying the content of another BinarySignal.
+ * @brief Calculates the time at which the specified run starts.
  * 
- * This constructor creates a BinarySignal that is an exact copy of another BinarySignal.
+ * Takes O(1) with the time index and O(index) without it.
  *
- * @param other The BinarySignal to copy.
+ * @param index The index of the run.
+ * @return The total time of the runs preceding the run.
  */
-  BinarySignal::BinarySignal(const BinarySignal& other) : count(other.count), signal(new SignalState[other.count]) {
-    std::copy(other.signal, other.signal + count, this->signal);
+  std::int64_t BinarySignal::timeBefore(int index) const{
+    if (index <= 0){
+      return 0;
+    }
+    if (ends){
+      return ends[index - 1];
+    }
+    std::int64_t sum_time = 0;
+    for (int i = 0; i < index; i++){
+      sum_time += times[i];
+    }
+    return sum_time;
   }
 
 /**
- * @brief Move constructor for BinarySignal.
+ * @brief Enables the cumulative time index.
  * 
- * This constructor transfers ownership of the signal data from the source BinarySignal to the new BinarySignal.
+ * With the index point lookups take O(log n) and totalTime() takes O(1).
+ * The index is kept up to date by every subsequent modification of the signal.
+ */
+  void BinarySignal::buildTimeIndex(){
+    if (ends){
+      return;
+    }
+    detach();
+    if (!refs){
+      refs = new std::atomic<int>(1);
+    }
+    ends = new std::int64_t[capacity ? capacity : 1];
+    updateIndex(0);
+  }
+
+/**
+ * @brief Disables the cumulative time index and releases its memory.
+ */
+  void BinarySignal::dropTimeIndex(){
+    if (!ends){
+      return;
+    }
+    detach();
+    delete[] ends;
+    ends = nullptr;
+  }
+
+/**
+ * @brief Checks whether the cumulative time index is enabled.
+ * 
+ * @return true if the time index is present.
+ */
+  bool BinarySignal::hasTimeIndex() const{
+    return ends != nullptr;
+  }
+
+/**
+ * @brief Finds the run covering the specified time.
+ * 
+ * Uses a binary search over the time index if it is present and a linear scan otherwise.
  *
- * @param other The BinarySignal to move from.
+ * @param time The time to look up.
+ * @return The index of the SignalState covering the time.
+ * @throw std::invalid_argument if the time is negative or not less than the total time.
  */
-  BinarySignal::BinarySignal(BinarySignal&& other) noexcept : count(other.count), signal(other.signal) {
-    other.count = 0;
-    other.signal = nullptr;
+  int BinarySignal::runIndexAt(std::int64_t time) const{
+    if (time < 0){
+      throw std::invalid_argument("error: invalid time");
+    }
+    if (ends){
+      int index = std::upper_bound(ends, ends + count, time) - ends;
+      if (index == count){
+        throw std::invalid_argument("error: invalid time");
+      }
+      return index;
+    }
+    std::int64_t sum_time = 0;
+    for (int i = 0; i < count; i++){
+      sum_time += times[i];
+      if (sum_time > time){
+        return i;
+      }
+    }
+    throw std::invalid_argument("error: invalid time");
   }
 
 /**
- * @brief Get the count of SignalState elements in the BinarySignal.
+ * @brief Samples the signal at many times sorted in non-decreasing order.
  * 
- * @return The number of SignalState elements in the BinarySignal.
+ * The runs are walked once, so the call takes O(runs + k) instead of one lookup per time.
+ *
+ * @param sorted_times The times to sample, in non-decreasing order.
+ * @param out The buffer receiving 0 or 1 per time, or SAMPLE_OUT_OF_RANGE for times outside the signal.
+ * @return The number of times inside the signal.
+ * @throw std::invalid_argument if the buffers differ in size or the times are not sorted.
  */
-  int BinarySignal::getCount() const {
-    return count;
+  std::size_t BinarySignal::sampleAt(std::span<const std::int64_t> sorted_times, std::span<std::uint8_t> out) const{
+    return view().sampleAt(sorted_times, out);
+  }
+
+/**
+ * @brief Samples the signal at many times given in any order.
+ * 
+ * Each time is found by a binary search over the time index, which is computed
+ * for the call if the signal has none.
+ *
+ * @param times The times to sample.
+ * @param out The buffer receiving 0 or 1 per time, or SAMPLE_OUT_OF_RANGE for times outside the signal.
+ * @return The number of times inside the signal.
+ * @throw std::invalid_argument if the buffers differ in size.
+ */
+  std::size_t BinarySignal::sampleAtUnsorted(std::span<const std::int64_t> times, std::span<std::uint8_t> out) const{
+    return view().sampleAtUnsorted(times, out);
   }
 
 /**
  * @brief Convert the BinarySignal to a string representation.
  * 
  * This function converts the BinarySignal to a string of '0' and '1' characters based on its SignalState elements.
+ * Long signals are rendered in parallel chunks of runs, each written at the offset given by a scan of the chunk times.
  *
  * @return A string representation of the BinarySignal.
  */
   std::string BinarySignal::toString() const {
-    std::string result;
-    for (int i = 0; i < this->count; i++){
-      result += std::string(this->signal[i].getTime(), (this->signal[i].getLevel() ? '1' : '0'));
+    std::string result(totalTime(), '\0');
+    std::size_t chunks = std::min<std::size_t>(parallelChunks((std::size_t)total), count);
+    if (chunks <= 1){
+      BufferSink sink(result.data());
+      render(sink, false);
+      return result;
+    }
+    auto bound = [this, chunks](std::size_t k){ return (int)((std::size_t)count * k / chunks); };
+    std::vector<std::int64_t> offsets(chunks + 1, 0);
+    parallelFor(chunks, [&](std::size_t k){
+      for (int i = bound(k); i < bound(k + 1); i++){
+        offsets[k + 1] += times[i];
+      }
+    });
+    for (std::size_t k = 0; k < chunks; k++){
+      offsets[k + 1] += offsets[k];
     }
+    parallelFor(chunks, [&](std::size_t k){
+      BufferSink sink(result.data() + offsets[k]);
+      for (int i = bound(k); i < bound(k + 1); i++){
+        sink.put(runLevel(i) ? '1' : '0', times[i]);
+      }
+    });
     return result;
   }
 
+/**
+ * @brief Renders the BinarySignal run by run into a sink.
+ * 
+ * The plain form writes '0' and '1' characters. The formatted form writes '.' and '\''
+ * and puts '/' or '\\' between runs, which are always of different levels in the canonical form.
+ *
+ * @param sink The target providing put(symbol, n).
+ * @param formated true for the formatSignal() chart, false for the '0'/'1' form.
+ */
+  template <class Sink>
+  void BinarySignal::render(Sink &sink, bool formated) const {
+    for (int i = 0; i < count; i++){
+      if (formated && i != 0){
+        sink.put(runLevel(i - 1) ? '\\' : '/', 1);
+      }
+      if (formated){
+        sink.put(runLevel(i) ? '\'' : '.', times[i]);
+      }
+      else{
+        sink.put(runLevel(i) ? '1' : '0', times[i]);
+      }
+    }
+  }
+
+/**
+ * @brief Convert the BinarySignal to a packed bitset.
+ * 
+ * Sample i is stored in bit i % 64 of word i / 64, the same layout fromSamples() accepts.
+ *
+ * @return The packed samples, ceil(totalTime() / 64) words.
+ */
+  std::vector<std::uint64_t> BinarySignal::toBits() const {
+    std::vector<std::uint64_t> bits(((std::size_t)totalTime() + 63) / 64);
+    toBits(bits);
+    return bits;
+  }
+
+/**
+ * @brief Writes the BinarySignal to a caller-provided packed bitset.
+ * 
+ * The required words are cleared at once, then every high run is set with partial-word
+ * masks at its ends and whole-word stores in between. Bits past the end of the signal
+ * in the last word are left zero.
+ *
+ * @param bits The buffer to write, must hold at least ceil(totalTime() / 64) words.
+ * @return The number of samples written, equal to totalTime().
+ * @throw std::invalid_argument if the buffer is too small.
+ */
+  std::size_t BinarySignal::toBits(std::span<std::uint64_t> bits) const {
+    std::size_t total_time = (std::size_t)totalTime();
+    std::size_t words = (total_time + 63) / 64;
+    if (bits.size() < words){
+      throw std::invalid_argument("error: bit buffer is too small");
+    }
+    std::fill(bits.begin(), bits.begin() + words, 0);
+    std::size_t start = 0;
+    for (int i = 0; i < count; i++){
+      std::size_t end = start + times[i];
+      if (runLevel(i)){
+        std::size_t first = start / 64;
+        std::size_t last = (end - 1) / 64;
+        std::uint64_t head = ~std::uint64_t(0) << (start % 64);
+        std::uint64_t tail = ~std::uint64_t(0) >> (63 - (end - 1) % 64);
+        if (first == last){
+          bits[first] |= head & tail;
+        }
+        else{
+          bits[first] |= head;
+          std::fill(bits.begin() + first + 1, bits.begin() + last, ~std::uint64_t(0));
+          bits[last] |= tail;
+        }
+      }
+      start = end;
+    }
+    return total_time;
+  }
+
 /**
  * @brief Move assignment operator for BinarySignal.
  * 
@@ -113,11 +1272,20 @@ namespace lab2{
  */
   BinarySignal& BinarySignal::operator =(BinarySignal&& other) noexcept  {
     if (this != &other) {
-      if (count != 0 && signal){ delete[] signal; }
+      release();
+      this->level = other.level;
+      this->total = other.total;
       this->count = other.count;
-      this->signal = other.signal;
+      this->capacity = other.capacity;
+      this->times = other.times;
+      this->ends = other.ends;
+      this->refs = other.refs;
       other.count = 0;
-      other.signal = nullptr;
+      other.capacity = 0;
+      other.total = 0;
+      other.times = nullptr;
+      other.ends = nullptr;
+      other.refs = nullptr;
     }
     return *this;
   }
@@ -125,8 +1293,8 @@ namespace lab2{
 /**
  * @brief Copy assignment operator for BinarySignal.
  * 
- * This operator assigns the content of another BinarySignal to this BinarySignal, creating a deep copy.
- * It releases the resources owned by this BinarySignal, if any.
+ * This operator makes this BinarySignal share the storage of another BinarySignal in O(1),
+ * the previous storage is released.
  *
  * @param other The BinarySignal to copy from.
  * @return A reference to the modified BinarySignal.
@@ -135,12 +1303,17 @@ namespace lab2{
     if (this == &other) {
       return *this;
     }
-    if (count != 0){ delete[] signal; }
-    this->count = other.count;
-    if (other.count != 0) {
-      this->signal = new SignalState[count];
+    if (other.refs){
+      other.refs->fetch_add(1, std::memory_order_relaxed);
     }
-    std::copy(other.signal, other.signal + count, this->signal);
+    release();
+    this->level = other.level;
+    this->count = other.count;
+    this->capacity = other.capacity;
+    this->total = other.total;
+    this->times = other.times;
+    this->ends = other.ends;
+    this->refs = other.refs;
     return *this;
   }
 
@@ -149,6 +1322,7 @@ namespace lab2{
  * 
  * This operator multiplies the BinarySignal by an integer n.
  * The signal is repeated n times. If n is less than or equal to 0, an exception is thrown.
+ * When the last run of the signal has the same level as the first one, they are merged at every seam.
  *
  * @param n The positive integer to multiply the BinarySignal by.
  * @return A reference to the modified BinarySignal.
@@ -160,19 +1334,44 @@ namespace lab2{
     else if (count == 0){
       return *this;
     }
+    std::int64_t new_total = checkedMul(total, (std::int64_t)n);
+    detach();
+    if (count == 1){
+      times[0] = new_total;
+      total = new_total;
+      updateIndex(0);
+    }
+    else if (count % 2 == 0){
+      int pattern = count;
+      reserve(checkedMul(pattern, n));
+      std::int64_t *data = times;
+      std::size_t chunks = std::min<std::size_t>(parallelChunks((std::size_t)pattern * n), n - 1);
+      parallelFor(chunks, [data, pattern, n, chunks](std::size_t k){
+        for (int i = 1 + (int)((n - 1) * k / chunks); i < 1 + (int)((n - 1) * (k + 1) / chunks); i++){
+          std::copy(data, data + pattern, data + (std::size_t)i * pattern);
+        }
+      });
+      count = pattern * n;
+      updateIndex(pattern);
+    }
     else{
-      SignalState *result = new SignalState[n * count];
-      int k = 0;
-      for (int i = 0; i < n; i++){
-        for (int j = 0; j < count; j++){
-          result[k] = signal[j];
-          k++;
+      int pattern = count;
+      std::int64_t last = times[pattern - 1];
+      reserve(checkedAdd(checkedMul(pattern - 1, n), 1));
+      std::int64_t *data = times;
+      std::size_t chunks = std::min<std::size_t>(parallelChunks((std::size_t)pattern * n), n - 1);
+      parallelFor(chunks, [data, pattern, n, chunks, last](std::size_t k){
+        for (int i = 1 + (int)((n - 1) * k / chunks); i < 1 + (int)((n - 1) * (k + 1) / chunks); i++){
+          std::int64_t *block = data + (std::size_t)i * (pattern - 1);
+          block[0] = last + data[0];
+          std::copy(data + 1, data + pattern - 1, block + 1);
         }
-      }
-      delete[] signal;
-      this->signal = result;
-      this->count = count * n;
+      });
+      count = (pattern - 1) * n + 1;
+      times[count - 1] = last;
+      updateIndex(pattern - 1);
     }
+    total = new_total;
     return *this;
   }
 
@@ -194,35 +1393,114 @@ namespace lab2{
     return result;
   }
 
+/**
+ * @brief Repeats the signal n times without storing the copies.
+ * 
+ * Unlike operator *, the result keeps a single copy of the runs, so its size does not depend on n.
+ * Use RepeatedSignal::materialize() to get a BinarySignal.
+ *
+ * @param n The positive number of repetitions.
+ * @return The lazily repeated signal.
+ * @throw std::invalid_argument if n is not positive.
+ * @throw std::overflow_error if the total time does not fit the time type.
+ */
+  RepeatedSignal BinarySignal::repeat(std::int64_t n) const{
+    return RepeatedSignal(*this, n);
+  }
+
+/**
+ * @brief Converts the signal to another time scale, with every time multiplied by num / den.
+ * 
+ * RESAMPLE_ROUND rounds the end of every run to the nearest unit of the new scale, so rounding
+ * errors do not accumulate. RESAMPLE_ANY and RESAMPLE_MAJORITY split the new scale into samples
+ * of den / num old units and make a sample high if any or more than half of it is high.
+ * Runs that collapse are dropped and their neighbours merged. Only samples containing
+ * a level change are computed one by one, so the call takes O(runs) for any ratio.
+ *
+ * @param num The numerator of the scale ratio.
+ * @param den The denominator of the scale ratio.
+ * @param policy RESAMPLE_ROUND, RESAMPLE_ANY or RESAMPLE_MAJORITY.
+ * @return The resampled signal.
+ * @throw std::invalid_argument if the ratio is not positive or the policy is invalid.
+ * @throw std::overflow_error if the total time multiplied by num does not fit the time type.
+ */
+  BinarySignal BinarySignal::resample(std::int64_t num, std::int64_t den, int policy) const{
+    if (num <= 0 || den <= 0){
+      throw std::invalid_argument("error: invalid resampling ratio");
+    }
+    if (policy != RESAMPLE_ROUND && policy != RESAMPLE_ANY && policy != RESAMPLE_MAJORITY){
+      throw std::invalid_argument("error: invalid resampling policy");
+    }
+    std::int64_t scaled_total = checkedMul(total, num);
+    BinarySignal result;
+    if (count == 0){
+      return result;
+    }
+    result.reserve(count);
+    if (policy == RESAMPLE_ROUND){
+      std::int64_t end_time = 0, previous = 0;
+      for (int i = 0; i < count; i++){
+        end_time += times[i];
+        std::int64_t scaled = scaleRounded(end_time, num, den);
+        result.pushRun(runLevel(i), scaled - previous);
+        previous = scaled;
+      }
+      return result;
+    }
+    std::int64_t samples = scaled_total / den + (scaled_total % den != 0);
+    std::int64_t sample = 0;
+    int run = 0;
+    std::int64_t run_end = times[0] * num;
+    while (sample < samples){
+      std::int64_t start = sample * den;
+      while (run_end <= start){
+        run++;
+        run_end += times[run] * num;
+      }
+      std::int64_t inside = (run_end == scaled_total) ? samples : run_end / den;
+      if (inside > sample){
+        result.pushRun(runLevel(run), inside - sample);
+        sample = inside;
+        continue;
+      }
+      std::int64_t end = (scaled_total - start < den) ? scaled_total : start + den;
+      std::int64_t high = 0;
+      std::int64_t from = start, to = run_end;
+      for (int i = run; ; i++){
+        if (i != run){
+          from = to;
+          to += times[i] * num;
+        }
+        if (runLevel(i)){
+          high += std::min(to, end) - from;
+        }
+        if (to >= end){
+          break;
+        }
+      }
+      bool sample_level = (policy == RESAMPLE_ANY) ? high > 0 : high > (end - start) - high;
+      result.pushRun(sample_level, 1);
+      sample++;
+    }
+    return result;
+  }
+
 /**
  * @brief In-place addition operator for BinarySignal.
  * 
  * This operator appends the BinarySignal with another BinarySignal. 
- * If the current BinarySignal is empty, it's replaced with the provided BinarySignal.
- * If the current BinarySignal consists of a single empty SignalState (time = 0), it's replaced with the provided BinarySignal.
+ * The last run of the current BinarySignal is merged with the first run of the other one when their levels are equal.
+ * The storage grows geometrically, so repeated appends cost amortized O(1) per SignalState.
  *
  * @param other The BinarySignal to append to the current BinarySignal.
  * @return A reference to the modified BinarySignal.
  */
   BinarySignal &BinarySignal::operator +=(const BinarySignal &other){
-    if (count == 0 || (this->count == 1 && this->signal[0].time == 0)){
-      *this = other;
-    }
-    if (other.count != 0){
-      SignalState *result = new SignalState[count + other.count];
-      int j = 0;
-      for (int i = 0; i < count; i++){
-        result[j] = signal[i];
-        j++;
-      }
-      for (int i = 0; i < other.count; i++){
-        result[j] = other.signal[i];
-        j++;
-      }
-      delete[] signal;
-      this->signal = result;
-      this->count = count + other.count;
+    if (this == &other){
+      BinarySignal copy(other);
+      return *this += copy;
     }
+    appendRuns(other.level, other.times, other.count);
     return *this;
   }
 
@@ -230,54 +1508,29 @@ namespace lab2{
  * @brief In-place addition operator for BinarySignal with SignalState.
  * 
  * This operator appends the BinarySignal with a single SignalState.
- * If the current BinarySignal is empty, it's replaced with the provided SignalState.
- * If the current BinarySignal consists of a single empty SignalState (time = 0), it's replaced with the provided SignalState.
+ * A SignalState with zero time is ignored, and a SignalState with the level of the last run extends that run.
+ * The storage grows geometrically, so repeated appends cost amortized O(1) each.
  *
  * @param other The SignalState to append to the current BinarySignal.
  * @return A reference to the modified BinarySignal.
  */
   BinarySignal &BinarySignal::operator +=(const SignalState &other){
-    if (count == 0){
-      signal = new SignalState[1];
-      signal[0] = other;
-      count = 1;
-      return *this;
-    }
-    if (this->count == 1 && this->signal[0].time == 0){
-      this->signal[0] = other;
-    }
-    if (other.time != 0){
-      SignalState *result = new SignalState[count + 1];
-      for (int i = 0; i < count; i++){
-        result[i] = signal[i];
-      }
-      result[count] = other;
-      delete[] signal;
-      this->signal = result;
-      this->count = count + 1;
-    }
+    pushRun(other.level, other.time);
     return *this;
   }
 
 /**
  * @brief Accesses the signal level at a specified time.
  * 
- * This operator returns the signal level (true for high, false for low) at the given time
- * by accumulating the time durations of individual SignalStates in the BinarySignal.
+ * This operator returns the signal level (true for high, false for low) at the given time.
+ * The covering SignalState is found by runIndexAt(), which takes O(log n) with the time index.
  * 
  * @param time The time at which to determine the signal level.
  * @return The signal level (true for high, false for low) at the specified time.
  * @throw std::invalid_argument if an invalid time is provided.
  */
-  bool BinarySignal::operator [](int time){
-    int sum_time = 0;
-    for (int i = 0; i < count; i++){
-      sum_time += signal[i].time;
-      if (sum_time > time){
-        return signal[i].level;
-      }
-    }
-    throw std::invalid_argument("error: invalid time");
+  bool BinarySignal::operator [](std::int64_t time) const{
+    return runLevel(runIndexAt(time));
   }
 
 /**
@@ -285,43 +1538,173 @@ namespace lab2{
  * 
  * This function inverts the signal represented by the BinarySignal
  * by changing the level (high to low and low to high) of each SignalState.
+ * Only the level of the first run is stored, so the inversion takes O(1).
  */
   void BinarySignal::invertSignal(){
-    for (int i = 0; i < count; i++){
-      signal[i].invertSignal();
-    }
+    level = !level;
   }
 
 /**
  * @brief Bitwise NOT operator for BinarySignal.
  * 
  * This operator inverts the signal by creating a new BinarySignal
- * with inverted SignalStates.
+ * with inverted SignalStates. The copy shares the storage, so the call is O(1).
  * 
  * @return A new BinarySignal with inverted SignalStates.
  */
   BinarySignal BinarySignal::operator ~(){
     BinarySignal result = *this;
-    for (int i = 0; i < count; i++){
-      result.signal[i].invertSignal();
+    result.invertSignal();
+    return result;
+  }
+
+/**
+ * @brief Bitwise NOT operator for a const BinarySignal.
+ * 
+ * Returns an inverted view over the runs of this signal, nothing is copied or allocated.
+ * The view is valid until the signal is modified or destroyed.
+ * 
+ * @return The inverted view.
+ */
+  BinarySignalView BinarySignal::operator ~() const{
+    return ~view();
+  }
+
+/**
+ * @brief Combines two signals of equal duration level by level.
+ * 
+ * The run arrays are walked with two pointers, every step emits the overlap of the current runs,
+ * so the cost is O(runs of this + runs of other) regardless of the duration.
+ * Equal neighbouring levels are merged by pushRun(), so the result is canonical.
+ *
+ * @param other The second operand.
+ * @param op Callable (level, other_level) returning the level of the result.
+ * @return The combined BinarySignal.
+ * @throw std::invalid_argument if the signals have different total times.
+ */
+  template <class Op>
+  BinarySignal BinarySignal::combine(const BinarySignal &other, Op op) const{
+    if (total != other.total){
+      throw std::invalid_argument("error: signals have different durations");
+    }
+    BinarySignal result;
+    if (count == 0){
+      return result;
+    }
+    result.reserve(checkedAdd(count, other.count - 1));
+    int i = 0, j = 0;
+    std::int64_t left = times[0], other_left = other.times[0];
+    while (i < count && j < other.count){
+      std::int64_t step = std::min(left, other_left);
+      result.pushRun(op(runLevel(i), other.runLevel(j)), step);
+      left -= step;
+      other_left -= step;
+      if (left == 0 && ++i < count){
+        left = times[i];
+      }
+      if (other_left == 0 && ++j < other.count){
+        other_left = other.times[j];
+      }
     }
     return result;
   }
 
 /**
- * @brief Calculate the total time duration of the signal.
+ * @brief Bitwise AND operator for BinarySignal.
+ * 
+ * @param other The signal to combine with, must have the same total time.
+ * @return A new BinarySignal that is high where both signals are high.
+ * @throw std::invalid_argument if the signals have different total times.
+ */
+  BinarySignal BinarySignal::operator &(const BinarySignal &other) const{
+    return combine(other, [](bool a, bool b){ return a && b; });
+  }
+
+/**
+ * @brief Bitwise OR operator for BinarySignal.
  * 
- * This function calculates and returns the total time duration
- * of the signal by summing the time durations of individual SignalStates.
+ * @param other The signal to combine with, must have the same total time.
+ * @return A new BinarySignal that is high where any of the signals is high.
+ * @throw std::invalid_argument if the signals have different total times.
+ */
+  BinarySignal BinarySignal::operator |(const BinarySignal &other) const{
+    return combine(other, [](bool a, bool b){ return a || b; });
+  }
+
+/**
+ * @brief Bitwise XOR operator for BinarySignal.
  * 
- * @return The total time duration of the signal.
+ * @param other The signal to combine with, must have the same total time.
+ * @return A new BinarySignal that is high where the signals have different levels.
+ * @throw std::invalid_argument if the signals have different total times.
  */
-  int BinarySignal::totalTime(){
-    int sum_time = 0;
-    for (int i = 0; i < count; i++){
-      sum_time += signal[i].time;
+  BinarySignal BinarySignal::operator ^(const BinarySignal &other) const{
+    return combine(other, [](bool a, bool b){ return a != b; });
+  }
+
+/**
+ * @brief In-place bitwise AND operator for BinarySignal.
+ * 
+ * The time index is kept if the signal had one.
+ *
+ * @param other The signal to combine with, must have the same total time.
+ * @return A reference to the modified BinarySignal.
+ * @throw std::invalid_argument if the signals have different total times.
+ */
+  BinarySignal &BinarySignal::operator &=(const BinarySignal &other){
+    BinarySignal result = *this & other;
+    if (ends){
+      result.buildTimeIndex();
     }
-    return sum_time;
+    *this = std::move(result);
+    return *this;
+  }
+
+/**
+ * @brief In-place bitwise OR operator for BinarySignal.
+ * 
+ * The time index is kept if the signal had one.
+ *
+ * @param other The signal to combine with, must have the same total time.
+ * @return A reference to the modified BinarySignal.
+ * @throw std::invalid_argument if the signals have different total times.
+ */
+  BinarySignal &BinarySignal::operator |=(const BinarySignal &other){
+    BinarySignal result = *this | other;
+    if (ends){
+      result.buildTimeIndex();
+    }
+    *this = std::move(result);
+    return *this;
+  }
+
+/**
+ * @brief In-place bitwise XOR operator for BinarySignal.
+ * 
+ * The time index is kept if the signal had one.
+ *
+ * @param other The signal to combine with, must have the same total time.
+ * @return A reference to the modified BinarySignal.
+ * @throw std::invalid_argument if the signals have different total times.
+ */
+  BinarySignal &BinarySignal::operator ^=(const BinarySignal &other){
+    BinarySignal result = *this ^ other;
+    if (ends){
+      result.buildTimeIndex();
+    }
+    *this = std::move(result);
+    return *this;
+  }
+
+/**
+ * @brief Get the total time duration of the signal.
+ * 
+ * The total is kept up to date by every modification, so the call is O(1).
+ * 
+ * @return The total time duration of the signal.
+ */
+  std::int64_t BinarySignal::totalTime() const{
+    return total;
   }
 
 /**
@@ -333,27 +1716,43 @@ namespace lab2{
  * are marked with either '/' (low to high) or '\' (high to low).
  * 
  * Example: ".../''''\./'\.." represents a BinarySignal with alternating 0s and 1s.
+ * The result is allocated once with its exact length and filled in a single pass.
  * 
  * @return The formatted string representation of the BinarySignal.
  */
   std::string BinarySignal::formatedSignal() const{
-    std::string formated_signal;
-    for (int i = 0; i < count; i++){
-      formated_signal += signal[i].formatSignal();
-    }
-    for (int i = 1; i < (int)formated_signal.length(); i++){
-      if (formated_signal[i-1] < formated_signal[i]){
-        formated_signal.insert(i, 1, '\\');
-        i++;
-      }
-      else if (formated_signal[i-1] > formated_signal[i]){
-        formated_signal.insert(i, 1, '/');
-        i++;
-      }
-    }
+    std::string formated_signal((std::size_t)totalTime() + (count != 0 ? count - 1 : 0), '\0');
+    BufferSink sink(formated_signal.data());
+    render(sink, true);
     return formated_signal;
   }
 
+/**
+ * @brief Writes the '0'/'1' form of the BinarySignal to an output stream.
+ * 
+ * The characters are produced in fixed-size chunks, the whole string is never materialized.
+ *
+ * @param output The output stream to write to.
+ */
+  void BinarySignal::write(std::ostream &output) const{
+    StreamSink sink(output);
+    render(sink, false);
+    sink.flush();
+  }
+
+/**
+ * @brief Writes the formatSignal() chart of the BinarySignal to an output stream.
+ * 
+ * The characters are produced in fixed-size chunks, the whole chart is never materialized.
+ *
+ * @param output The output stream to write to.
+ */
+  void BinarySignal::writeFormated(std::ostream &output) const{
+    StreamSink sink(output);
+    render(sink, true);
+    sink.flush();
+  }
+
 /**
  * @brief Inserts another BinarySignal at the specified time into the current BinarySignal.
  *
@@ -369,8 +1768,8 @@ namespace lab2{
  * @throw std::invalid_argument If the insertion time is negative or greater than the
  * total duration of the current BinarySignal.
  */
-  BinarySignal &BinarySignal::insertSignal(const BinarySignal &other, int time) {
-    int total_time = this->totalTime();
+  BinarySignal &BinarySignal::insertSignal(const BinarySignal &other, std::int64_t time) {
+    std::int64_t total_time = this->totalTime();
     if (time < 0 || total_time < time) {
       throw std::invalid_argument("error: invalid insertion time");
     }
@@ -378,42 +1777,23 @@ namespace lab2{
       *this += other;
       return *this;
     }
-    int start_time = time;
-
-    if (start_time == 0){
-      BinarySignal result(other);
-      result += *this;
-      delete [] signal;
-      *this = result;
-      return *this;
-    }
-
-    BinarySignal before_interval;
-    BinarySignal after_interval;
 
-    int sum_time = 0;
+    checkedAdd(total_time, other.total);
+    int index = runIndexAt(time);
+    std::int64_t offset = time - timeBefore(index);
 
-    for (int i = 0; i < count; i++) {
-      sum_time += signal[i].time;
-      if (sum_time < time) {
-        before_interval += signal[i];
-      } 
-      else if (sum_time == time) {
-        before_interval += signal[i];
-        before_interval += other;
-      } 
-      else if (sum_time - signal[i].time < time) {
-        before_interval += SignalState(signal[i].level, start_time - sum_time + signal[i].time);
-        before_interval += other;
-        after_interval += SignalState(signal[i].level, sum_time - start_time);
-      }
-      if (sum_time - signal[i].time > time) {
-        after_interval += signal[i];
-      }
+    BinarySignal result;
+    result.reserve(count + other.count + 1);
+    if (ends){
+      result.buildTimeIndex();
     }
+    result.appendRuns(level, times, index);
+    result.pushRun(runLevel(index), offset);
+    result += other;
+    result.pushRun(runLevel(index), times[index] - offset);
+    result.appendRuns(runLevel(index + 1), times + index + 1, count - index - 1);
 
-    before_interval += after_interval;
-    *this = before_interval;
+    *this = std::move(result);
     return *this;
   }
 
@@ -423,49 +1803,42 @@ namespace lab2{
  * This function removes a segment of the signal from the BinarySignal based on the
  * specified time and duration. If the time and duration parameters are valid, this
  * function modifies the current BinarySignal by removing the specified segment.
+ * The boundary runs are located by runIndexAt(), which takes O(log n) with the time index.
  *
  * @param time The starting time of the segment to be removed.
  * @param duration The duration of the segment to be removed.
  *
  * @return A reference to the modified current BinarySignal.
  *
- * @throw std::invalid_argument If the provided time is negative or if the sum of the
+ * @throw std::invalid_argument If the provided time or duration is negative or if the sum of the
  * provided time and duration exceeds the total duration of the current BinarySignal.
  */
-  BinarySignal &BinarySignal::removeSignal(int time, int duration) {
-    int total_time = this->totalTime();
-    if (time < 0 || total_time < time + duration) {
+  BinarySignal &BinarySignal::removeSignal(std::int64_t time, std::int64_t duration) {
+    std::int64_t total_time = this->totalTime();
+    if (time < 0 || duration < 0 || total_time < time || total_time - time < duration) {
       throw std::invalid_argument("error: invalid time");
     }
+    if (duration == 0){
+      return *this;
+    }
 
-    int start_time = time;
-    int end_time = time + duration - 1;
-
-    BinarySignal before_interval;
-    BinarySignal after_interval;
+    std::int64_t end_time = time + duration;
+    int first = runIndexAt(time);
+    int last = runIndexAt(end_time - 1);
+    std::int64_t head = time - timeBefore(first);
+    std::int64_t tail = timeBefore(last) + times[last] - end_time;
 
-    int sum_time = 0;
-    for (int i = 0; i < count; i++) {
-      sum_time += signal[i].time;
-      if (sum_time <= start_time) {
-        before_interval += signal[i];
-      } 
-      else if (sum_time - signal[i].time > end_time) {
-          after_interval += signal[i];
-      } 
-      else {
-        if (sum_time - signal[i].time < start_time) {
-          before_interval += SignalState(signal[i].level, start_time - sum_time + signal[i].time);
-        }
-	if (1 < sum_time - end_time && sum_time - end_time <= signal[i].time) {
-          after_interval += SignalState(signal[i].level, sum_time - end_time - 1);
-        }
-      }
+    BinarySignal result;
+    result.reserve(count - (last - first) + 1);
+    if (ends){
+      result.buildTimeIndex();
     }
+    result.appendRuns(level, times, first);
+    result.pushRun(runLevel(first), head);
+    result.pushRun(runLevel(last), tail);
+    result.appendRuns(runLevel(last + 1), times + last + 1, count - last - 1);
 
-    before_interval += after_interval;
-    *this = before_interval;
-
+    *this = std::move(result);
     return *this;
   }
 
@@ -484,7 +1857,7 @@ namespace lab2{
     switch(input_format){
       case NUMBER_FORMAT:{
         bool lvl = getNum(0, 1);
-        int time = getNum(1);
+        std::int64_t time = getNum<std::int64_t>(1);
         *this = BinarySignal(lvl, time);
         break;
       }
@@ -511,30 +1884,23 @@ namespace lab2{
  * The signal segments are printed consecutively.
  */
   void BinarySignal::output() const{
-    for (int i = 0; i < count; i++) {
-      char ch_lvl = signal[i].level ? '1' : '0';
-      std::cout << std::string(signal[i].time, ch_lvl);
-    }
+    write(std::cout);
     std::cout << std::endl;
   }
 
 /**
  * @brief Overload for the output stream operator (<<) to print a BinarySignal to an output stream.
  *
- * This overload allows a BinarySignal to be printed to an output stream, such as std::cout, by
- * converting it into a string representation. The BinarySignal is converted into a string where
- * each segment of the signal is represented by a sequence of '0' or '1' characters.
+ * This overload allows a BinarySignal to be printed to an output stream, such as std::cout.
+ * Each segment of the signal is represented by a sequence of '0' or '1' characters, streamed
+ * in chunks by BinarySignal::write() without building a temporary string.
  *
  * @param output The output stream where the BinarySignal will be printed.
  * @param state The BinarySignal to be printed.
  * @return The output stream after printing the BinarySignal.
  */
   std::ostream &operator <<(std::ostream &output, const BinarySignal &state){
-    std::string signal_str;
-    for (int i = 0; i < state.count; i++){
-      signal_str += std::string(state.signal[i].getTime(), (state.signal[i].getLevel() ? '1' : '0'));
-    }
-    output << signal_str;
+    state.write(output);
     return output;
   }
 
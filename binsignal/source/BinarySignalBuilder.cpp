@@ -0,0 +1,159 @@
+#include <stdexcept>
+
+#include "BinarySignalBuilder.h"
+
+namespace lab2{
+
+/**
+ * @brief Constructs a builder that keeps the whole capture.
+ */
+  BinarySignalBuilder::BinarySignalBuilder() : horizon(0), dropped(0) {}
+
+/**
+ * @brief Constructs a builder in the ring mode.
+ *
+ * The oldest runs are dropped once the kept time exceeds twice the horizon, so at least
+ * the last horizon time units and at most twice as much are kept. Dropping in batches
+ * keeps the cost of an append amortized O(1).
+ *
+ * @param horizon The time to keep, 0 to keep everything.
+ * @throw std::invalid_argument if horizon is negative.
+ */
+  BinarySignalBuilder::BinarySignalBuilder(std::int64_t horizon) : horizon(horizon), dropped(0) {
+    if (horizon < 0){
+      throw std::invalid_argument("error: invalid horizon");
+    }
+  }
+
+/**
+ * @brief Appends a run or a single sample.
+ *
+ * A level equal to the level of the last run extends that run in place.
+ *
+ * @param level The level of the samples.
+ * @param time The number of samples, 1 by default.
+ * @return A reference to the builder.
+ * @throw std::invalid_argument if time is negative.
+ */
+  BinarySignalBuilder &BinarySignalBuilder::append(bool level, std::int64_t time){
+    if (time < 0){
+      throw std::invalid_argument("error: invalid signal state");
+    }
+    if (time == 0){
+      return *this;
+    }
+    signal += SignalState(level, time);
+    trim();
+    return *this;
+  }
+
+/**
+ * @brief Appends a block of byte samples, every non-zero sample is a high level.
+ *
+ * The block is encoded by the SIMD scanners and its first run is merged with the last run.
+ *
+ * @param samples The samples, one per time unit.
+ * @return A reference to the builder.
+ */
+  BinarySignalBuilder &BinarySignalBuilder::append(std::span<const std::uint8_t> samples){
+    signal += BinarySignal(samples);
+    trim();
+    return *this;
+  }
+
+/**
+ * @brief Appends a block of int samples, every non-zero sample is a high level.
+ *
+ * @param samples The samples, one per time unit.
+ * @return A reference to the builder.
+ */
+  BinarySignalBuilder &BinarySignalBuilder::append(std::span<const int> samples){
+    signal += BinarySignal(samples);
+    trim();
+    return *this;
+  }
+
+/**
+ * @brief Appends the runs of a signal.
+ *
+ * @param block The signal to append.
+ * @return A reference to the builder.
+ */
+  BinarySignalBuilder &BinarySignalBuilder::append(const BinarySignal &block){
+    signal += block;
+    trim();
+    return *this;
+  }
+
+/**
+ * @brief Drops the oldest runs in the ring mode once twice the horizon is exceeded.
+ */
+  void BinarySignalBuilder::trim(){
+    if (horizon == 0 || signal.totalTime() - horizon <= horizon){
+      return;
+    }
+    std::int64_t excess = signal.totalTime() - horizon;
+    signal.removeSignal(0, excess);
+    dropped += excess;
+  }
+
+/**
+ * @brief Publishes the runs appended so far.
+ *
+ * The snapshot shares the storage with the builder, so the call is O(1). It is immutable
+ * from the point of view of the builder: the next append clones the storage once, which
+ * costs O(runs) while the snapshot is alive. Appends stay amortized O(1) only if snapshots
+ * are taken rarely compared to appends; a reader that polls a growing capture often should
+ * use ConcurrentSignal, whose snapshots never copy.
+ *
+ * @return The signal; in the ring mode it starts at droppedTime() of the capture.
+ */
+  BinarySignal BinarySignalBuilder::snapshot() const {
+    return signal;
+  }
+
+/**
+ * @brief Get the number of runs kept by the builder.
+ *
+ * @return The number of runs.
+ */
+  int BinarySignalBuilder::getCount() const {
+    return signal.getCount();
+  }
+
+/**
+ * @brief Get the time kept by the builder.
+ *
+ * @return The total time of the kept runs.
+ */
+  std::int64_t BinarySignalBuilder::totalTime() const {
+    return signal.totalTime();
+  }
+
+/**
+ * @brief Get the time dropped in the ring mode.
+ *
+ * @return The capture time of the first kept sample.
+ */
+  std::int64_t BinarySignalBuilder::droppedTime() const {
+    return dropped;
+  }
+
+/**
+ * @brief Get the time kept in the ring mode.
+ *
+ * @return The horizon, 0 if the whole capture is kept.
+ */
+  std::int64_t BinarySignalBuilder::getHorizon() const {
+    return horizon;
+  }
+
+/**
+ * @brief Drops all runs, snapshots taken before stay valid.
+ */
+  void BinarySignalBuilder::clear(){
+    signal = BinarySignal();
+    dropped = 0;
+  }
+
+}
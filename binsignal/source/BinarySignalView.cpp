@@ -0,0 +1,444 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iostream>
+
+#include "BinarySignalView.h"
+#include "RenderSink.h"
+#include "SignalFile.h"
+
+namespace lab2{
+
+  namespace {
+
+/**
+ * @brief Reads a little-endian unsigned integer of the given width.
+ */
+    std::uint64_t readLittleEndian(const unsigned char *data, int width){
+      std::uint64_t value = 0;
+      for (int i = width - 1; i >= 0; i--){
+        value = (value << 8) | data[i];
+      }
+      return value;
+    }
+
+  }
+
+/**
+ * @brief Constructs a BinarySignalView over a signal saved by BinarySignal::save().
+ *
+ * The header is checked and the view points directly at the run lengths in the buffer,
+ * nothing is copied or decoded. The buffer must outlive the view, be aligned to 8 bytes
+ * and hold the FIXED_ENCODING format.
+ *
+ * Unless validation is turned off, the runs are read once to check that every run is
+ * positive, that they sum to the total in the header and that the time index, if present,
+ * holds their cumulative ends. Without it a malformed buffer makes later calls read or
+ * write out of bounds, so only skip it for data that is already known to be valid.
+ *
+ * @param data Pointer to the beginning of the saved signal, e.g. a mapped file.
+ * @param size The size of the buffer in bytes.
+ * @param validate Whether to check the runs and the time index against the header.
+ * @throw std::invalid_argument if the buffer does not hold a valid signal in the fixed-width encoding.
+ */
+  BinarySignalView::BinarySignalView(const void *data, std::size_t size, bool validate) : level(false), count(0), times(nullptr), ends(nullptr), total(0), head(0), tail(0), base(0) {
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    if (size < SIGNAL_HEADER_SIZE || std::memcmp(bytes, "BSIG", 4) != 0){
+      throw std::invalid_argument("error: invalid signal file");
+    }
+    if (readLittleEndian(bytes + 4, 2) != SIGNAL_FILE_VERSION){
+      throw std::invalid_argument("error: unsupported signal file version");
+    }
+    if (bytes[6] != FIXED_ENCODING || std::endian::native != std::endian::little){
+      throw std::invalid_argument("error: signal file can not be viewed in place");
+    }
+    if (reinterpret_cast<std::uintptr_t>(data) % alignof(std::int64_t) != 0){
+      throw std::invalid_argument("error: misaligned signal data");
+    }
+    std::uint64_t runs = readLittleEndian(bytes + 8, 8);
+    std::uint64_t arrays = (bytes[7] & SIGNAL_FLAG_INDEX) ? 2 : 1;
+    if (runs > (std::uint64_t)std::numeric_limits<int>::max() || runs * arrays * 8 > size - SIGNAL_HEADER_SIZE){
+      throw std::invalid_argument("error: truncated signal file");
+    }
+    this->level = bytes[7] & SIGNAL_FLAG_LEVEL;
+    this->count = (int)runs;
+    this->total = (std::int64_t)readLittleEndian(bytes + 16, 8);
+    this->times = reinterpret_cast<const std::int64_t *>(bytes + SIGNAL_HEADER_SIZE);
+    this->ends = (arrays == 2) ? times + count : nullptr;
+    if (validate){
+      std::int64_t sum_time = 0;
+      for (int i = 0; i < count; i++){
+        if (times[i] <= 0 || __builtin_add_overflow(sum_time, times[i], &sum_time) || (ends && ends[i] != sum_time)){
+          throw std::invalid_argument("error: invalid signal file");
+        }
+      }
+      if (sum_time != total){
+        throw std::invalid_argument("error: invalid signal file");
+      }
+    }
+    if (count != 0){
+      this->head = times[0];
+      this->tail = times[count - 1];
+    }
+  }
+
+/**
+ * @brief Constructs a BinarySignalView over runs held in memory, e.g. by a BinarySignal.
+ *
+ * Nothing is copied, the runs must outlive the view and stay unchanged.
+ *
+ * @param level The level of the first run.
+ * @param count The number of runs.
+ * @param times Pointer to the run durations.
+ * @param ends Pointer to the cumulative end times of the runs, or nullptr if there is no time index.
+ * @param total The sum of the run durations.
+ */
+  BinarySignalView::BinarySignalView(bool level, int count, const std::int64_t *times, const std::int64_t *ends, std::int64_t total) :
+    level(level), count(count), times(times), ends(ends), total(total),
+    head(count ? times[0] : 0), tail(count ? times[count - 1] : 0), base(0) {}
+
+/**
+ * @brief Get the duration of a run inside the view.
+ *
+ * The first and the last run are clipped by the bounds of a slice.
+ */
+  std::int64_t BinarySignalView::runTime(int index) const {
+    if (index == count - 1){
+      return tail;
+    }
+    return (index == 0) ? head : times[index];
+  }
+
+/**
+ * @brief Calculates the time at which the specified run starts inside the view.
+ *
+ * Takes O(1) with the time index and O(index) without it.
+ */
+  std::int64_t BinarySignalView::timeBefore(int index) const {
+    if (index <= 0){
+      return 0;
+    }
+    if (ends){
+      return ends[index - 1] - base;
+    }
+    std::int64_t sum_time = 0;
+    for (int i = 0; i < index; i++){
+      sum_time += runTime(i);
+    }
+    return sum_time;
+  }
+
+/**
+ * @brief Get the number of runs in the view.
+ *
+ * @return The number of runs.
+ */
+  int BinarySignalView::getCount() const {
+    return count;
+  }
+
+/**
+ * @brief Checks whether the viewed data carries the cumulative time index.
+ *
+ * @return true if runIndexAt() and operator[] use a binary search.
+ */
+  bool BinarySignalView::hasTimeIndex() const {
+    return ends != nullptr;
+  }
+
+/**
+ * @brief Get the total time of the viewed signal.
+ *
+ * The value is stored in the header, so the call is O(1).
+ *
+ * @return The total time duration.
+ */
+  std::int64_t BinarySignalView::totalTime() const {
+    return total;
+  }
+
+/**
+ * @brief Get the run with the given index.
+ *
+ * The level is derived from the initial level, since levels alternate between runs.
+ *
+ * @param index The index of the run.
+ * @return The run as a SignalState.
+ * @throw std::invalid_argument if the index is out of range.
+ */
+  SignalState BinarySignalView::getState(int index) const {
+    if (index < 0 || index >= count){
+      throw std::invalid_argument("error: invalid index");
+    }
+    return SignalState(level != (index % 2 != 0), runTime(index));
+  }
+
+/**
+ * @brief Finds the run covering the specified time.
+ *
+ * Uses a binary search over the time index if it is present and a linear scan otherwise.
+ *
+ * @param time The time to look up.
+ * @return The index of the run covering the time.
+ * @throw std::invalid_argument if the time is negative or not less than the total time.
+ */
+  int BinarySignalView::runIndexAt(std::int64_t time) const {
+    if (time < 0 || time >= total){
+      throw std::invalid_argument("error: invalid time");
+    }
+    if (ends){
+      return std::upper_bound(ends, ends + count, time + base) - ends;
+    }
+    std::int64_t sum_time = 0;
+    for (int i = 0; i < count; i++){
+      sum_time += runTime(i);
+      if (sum_time > time){
+        return i;
+      }
+    }
+    throw std::invalid_argument("error: invalid time");
+  }
+
+/**
+ * @brief Accesses the signal level at a specified time.
+ *
+ * @param time The time at which to determine the signal level.
+ * @return The signal level (true for high, false for low) at the specified time.
+ * @throw std::invalid_argument if an invalid time is provided.
+ */
+  bool BinarySignalView::operator [](std::int64_t time) const {
+    return level != (runIndexAt(time) % 2 != 0);
+  }
+
+/**
+ * @brief Inversion operator for BinarySignalView.
+ *
+ * Only the level of the first run is flipped, the runs are shared, so the call is O(1).
+ *
+ * @return The inverted view over the same runs.
+ */
+  BinarySignalView BinarySignalView::operator ~() const {
+    BinarySignalView result = *this;
+    result.level = !level;
+    return result;
+  }
+
+/**
+ * @brief Creates a view over a time interval of the viewed signal.
+ *
+ * The result points into the same runs with the first and the last run clipped,
+ * nothing is copied. The boundary runs are found by runIndexAt(), so the call takes
+ * O(log n) with the time index.
+ *
+ * @param time The start of the interval.
+ * @param duration The duration of the interval.
+ * @return The view over the interval.
+ * @throw std::invalid_argument if the interval is not inside the signal.
+ */
+  BinarySignalView BinarySignalView::slice(std::int64_t time, std::int64_t duration) const {
+    if (time < 0 || duration < 0 || total < time || total - time < duration){
+      throw std::invalid_argument("error: invalid time");
+    }
+    if (duration == 0){
+      return BinarySignalView();
+    }
+    int first = runIndexAt(time);
+    int last = runIndexAt(time + duration - 1);
+    return cut(first, timeBefore(first), last, timeBefore(last), time, duration);
+  }
+
+/**
+ * @brief Creates the view over [time, time + duration) once its boundary runs are known.
+ *
+ * @param first The run covering time.
+ * @param first_start The time at which the first run starts inside this view.
+ * @param last The run covering time + duration - 1.
+ * @param last_start The time at which the last run starts inside this view.
+ * @param time The start of the interval.
+ * @param duration The positive duration of the interval.
+ */
+  BinarySignalView BinarySignalView::cut(int first, std::int64_t first_start, int last, std::int64_t last_start, std::int64_t time, std::int64_t duration) const {
+    BinarySignalView result;
+    result.level = level != (first % 2 != 0);
+    result.count = last - first + 1;
+    result.times = times + first;
+    result.ends = ends ? ends + first : nullptr;
+    result.total = duration;
+    result.base = base + time;
+    result.head = first_start + runTime(first) - time;
+    result.tail = time + duration - last_start;
+    if (first == last){
+      result.head = result.tail = duration;
+    }
+    return result;
+  }
+
+/**
+ * @brief Samples the view at many times sorted in non-decreasing order.
+ *
+ * The runs are walked once together with the times, so the call takes O(runs + k).
+ * Times outside the view are reported as SAMPLE_OUT_OF_RANGE instead of throwing.
+ *
+ * @param sorted_times The times to sample, in non-decreasing order.
+ * @param out The buffer receiving 0 or 1 per time, or SAMPLE_OUT_OF_RANGE.
+ * @return The number of times inside the view.
+ * @throw std::invalid_argument if the buffers differ in size or the times are not sorted.
+ */
+  std::size_t BinarySignalView::sampleAt(std::span<const std::int64_t> sorted_times, std::span<std::uint8_t> out) const {
+    if (sorted_times.size() != out.size()){
+      throw std::invalid_argument("error: invalid buffer size");
+    }
+    std::size_t found = 0;
+    int run = 0;
+    std::int64_t run_end = (count != 0) ? runTime(0) : 0;
+    for (std::size_t i = 0; i < sorted_times.size(); i++){
+      std::int64_t time = sorted_times[i];
+      if (i != 0 && time < sorted_times[i - 1]){
+        throw std::invalid_argument("error: times are not sorted");
+      }
+      if (time < 0 || time >= total){
+        out[i] = SAMPLE_OUT_OF_RANGE;
+        continue;
+      }
+      while (run_end <= time){
+        run++;
+        run_end += runTime(run);
+      }
+      out[i] = level != (run % 2 != 0);
+      found++;
+    }
+    return found;
+  }
+
+/**
+ * @brief Samples the view at many times given in any order.
+ *
+ * Every time is looked up by a binary search over the time index, so the call takes
+ * O(k log runs). Without the index the cumulative run ends are computed once first.
+ * Times outside the view are reported as SAMPLE_OUT_OF_RANGE instead of throwing.
+ *
+ * @param times The times to sample.
+ * @param out The buffer receiving 0 or 1 per time, or SAMPLE_OUT_OF_RANGE.
+ * @return The number of times inside the view.
+ * @throw std::invalid_argument if the buffers differ in size.
+ */
+  std::size_t BinarySignalView::sampleAtUnsorted(std::span<const std::int64_t> times, std::span<std::uint8_t> out) const {
+    if (times.size() != out.size()){
+      throw std::invalid_argument("error: invalid buffer size");
+    }
+    std::vector<std::int64_t> local;
+    const std::int64_t *index = ends;
+    std::int64_t offset = base;
+    if (!index){
+      local.resize(count);
+      std::int64_t sum_time = 0;
+      for (int i = 0; i < count; i++){
+        sum_time += runTime(i);
+        local[i] = sum_time;
+      }
+      index = local.data();
+      offset = 0;
+    }
+    std::size_t found = 0;
+    for (std::size_t i = 0; i < times.size(); i++){
+      std::int64_t time = times[i];
+      if (time < 0 || time >= total){
+        out[i] = SAMPLE_OUT_OF_RANGE;
+        continue;
+      }
+      int run = std::upper_bound(index, index + count, time + offset) - index;
+      out[i] = level != (run % 2 != 0);
+      found++;
+    }
+    return found;
+  }
+
+/**
+ * @brief Get the range of level changes of the view.
+ *
+ * The edges are produced lazily from the runs, an edge lies at the start of every run but the first.
+ *
+ * @param kind EDGE_ANY, EDGE_RISING or EDGE_FALLING.
+ * @return The range of edges ordered by time.
+ * @throw std::invalid_argument if kind is not a valid edge kind.
+ */
+  EdgeRange BinarySignalView::edges(int kind) const {
+    if (kind != EDGE_ANY && kind != EDGE_RISING && kind != EDGE_FALLING){
+      throw std::invalid_argument("error: invalid edge kind");
+    }
+    return EdgeRange(*this, kind);
+  }
+
+/**
+ * @brief Get the range of rising edges of the view.
+ *
+ * @return The range of edges ordered by time.
+ */
+  EdgeRange BinarySignalView::risingEdges() const {
+    return EdgeRange(*this, EDGE_RISING);
+  }
+
+/**
+ * @brief Get the range of falling edges of the view.
+ *
+ * @return The range of edges ordered by time.
+ */
+  EdgeRange BinarySignalView::fallingEdges() const {
+    return EdgeRange(*this, EDGE_FALLING);
+  }
+
+/**
+ * @brief Writes the level changes of the view into a buffer.
+ *
+ * Stops when the buffer is full, so the edges may be fetched in parts from slices.
+ *
+ * @param buffer The buffer to fill.
+ * @param kind EDGE_ANY, EDGE_RISING or EDGE_FALLING.
+ * @return The number of edges written.
+ * @throw std::invalid_argument if kind is not a valid edge kind.
+ */
+  std::size_t BinarySignalView::copyEdges(std::span<Edge> buffer, int kind) const {
+    if (kind != EDGE_ANY && kind != EDGE_RISING && kind != EDGE_FALLING){
+      throw std::invalid_argument("error: invalid edge kind");
+    }
+    std::size_t written = 0;
+    std::int64_t time = (count != 0) ? head : 0;
+    for (int i = 1; i < count && written < buffer.size(); i++){
+      bool rising = level != (i % 2 != 0);
+      if (kind == EDGE_ANY || rising == (kind == EDGE_RISING)){
+        buffer[written] = Edge{time, rising};
+        written++;
+      }
+      time += runTime(i);
+    }
+    return written;
+  }
+
+/**
+ * @brief Convert the viewed signal to a string of '0' and '1' characters.
+ *
+ * @return A string representation of the signal.
+ */
+  std::string BinarySignalView::toString() const {
+    std::string result(total, '\0');
+    BufferSink sink(result.data());
+    for (int i = 0; i < count; i++){
+      sink.put((level != (i % 2 != 0)) ? '1' : '0', runTime(i));
+    }
+    return result;
+  }
+
+/**
+ * @brief Writes the '0'/'1' form of the viewed signal to an output stream in fixed-size chunks.
+ *
+ * @param output The output stream to write to.
+ */
+  void BinarySignalView::write(std::ostream &output) const {
+    StreamSink sink(output);
+    for (int i = 0; i < count; i++){
+      sink.put((level != (i % 2 != 0)) ? '1' : '0', runTime(i));
+    }
+    sink.flush();
+  }
+
+}
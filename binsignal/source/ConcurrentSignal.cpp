@@ -0,0 +1,225 @@
+#include <stdexcept>
+#include <limits>
+
+#include "ConcurrentSignal.h"
+
+namespace lab2{
+
+/**
+ * @brief Constructs an empty signal for one writer and many readers.
+ *
+ * Runs are stored in chunks of CONCURRENT_CHUNK_RUNS runs reached through a directory of
+ * fixed size, so published runs never move and are freed only by the destructor.
+ */
+  ConcurrentSignal::ConcurrentSignal() : directory(new std::atomic<Chunk *>[CONCURRENT_DIRECTORY_SIZE]()), sequence(0),
+    first_level(false), published_count(0), published_last(0), published_total(0),
+    level(false), count(0), last_time(0), total(0) {}
+
+/**
+ * @brief Frees the chunks. Snapshots become invalid.
+ */
+  ConcurrentSignal::~ConcurrentSignal(){
+    for (int i = 0; i < CONCURRENT_DIRECTORY_SIZE; i++){
+      delete directory[i].load(std::memory_order_relaxed);
+    }
+    delete[] directory;
+  }
+
+/**
+ * @brief Stores the last run in its chunk, from now on it is never modified.
+ */
+  void ConcurrentSignal::closeLastRun(){
+    std::int64_t index = count - 1;
+    std::int64_t slot = index % CONCURRENT_CHUNK_RUNS;
+    Chunk *chunk = directory[index / CONCURRENT_CHUNK_RUNS].load(std::memory_order_relaxed);
+    if (!chunk){
+      chunk = new Chunk;
+      directory[index / CONCURRENT_CHUNK_RUNS].store(chunk, std::memory_order_release);
+    }
+    chunk->times[slot] = last_time;
+    chunk->ends[slot] = total;
+  }
+
+/**
+ * @brief Appends a run. Must be called by one thread at a time.
+ *
+ * A run with the level of the last run extends it. The new state is published with a
+ * sequence lock: readers never block the writer and see either the old or the new state.
+ *
+ * @param level The level of the run.
+ * @param time The duration of the run.
+ * @throw std::invalid_argument if time is negative or the signal has too many runs.
+ * @throw std::overflow_error if the total time does not fit the time type.
+ */
+  void ConcurrentSignal::append(bool level, std::int64_t time){
+    if (time < 0){
+      throw std::invalid_argument("error: invalid signal state");
+    }
+    if (time == 0){
+      return;
+    }
+    std::int64_t new_total = checkedAdd(total, time);
+    bool extend = (count != 0) && ((this->level != ((count - 1) % 2 != 0)) == level);
+    if (!extend && count == (std::int64_t)CONCURRENT_CHUNK_RUNS * CONCURRENT_DIRECTORY_SIZE){
+      throw std::invalid_argument("error: signal is too long");
+    }
+    if (extend){
+      last_time += time;
+    }
+    else{
+      if (count != 0){
+        closeLastRun();
+      }
+      else{
+        this->level = level;
+      }
+      count++;
+      last_time = time;
+    }
+    total = new_total;
+    std::uint64_t current = sequence.load(std::memory_order_relaxed);
+    sequence.store(current + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    first_level.store(this->level, std::memory_order_relaxed);
+    published_count.store(count, std::memory_order_relaxed);
+    published_last.store(last_time, std::memory_order_relaxed);
+    published_total.store(total, std::memory_order_relaxed);
+    sequence.store(current + 2, std::memory_order_release);
+  }
+
+/**
+ * @brief Appends the runs of a signal. Must be called by one thread at a time.
+ *
+ * @param signal The signal to append.
+ */
+  void ConcurrentSignal::append(const BinarySignal &signal){
+    for (SignalState state : signal){
+      append(state.getLevel(), state.getTime());
+    }
+  }
+
+/**
+ * @brief Takes a consistent snapshot of the published runs in O(1).
+ *
+ * Safe to call from any number of threads while the writer appends; no lock is taken,
+ * the read is only retried if it overlapped with a publication. The snapshot stays
+ * unchanged and valid while the ConcurrentSignal exists.
+ *
+ * @return The snapshot.
+ */
+  ConcurrentSignal::Snapshot ConcurrentSignal::snapshot() const {
+    Snapshot result;
+    result.directory = directory;
+    while (true){
+      std::uint64_t before = sequence.load(std::memory_order_acquire);
+      if (before % 2 != 0){
+        continue;
+      }
+      result.level = first_level.load(std::memory_order_relaxed);
+      result.count = published_count.load(std::memory_order_relaxed);
+      result.last_time = published_last.load(std::memory_order_relaxed);
+      result.total = published_total.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence.load(std::memory_order_relaxed) == before){
+        return result;
+      }
+    }
+  }
+
+  std::int64_t ConcurrentSignal::Snapshot::endOf(std::int64_t index) const {
+    if (index == count - 1){
+      return total;
+    }
+    return directory[index / CONCURRENT_CHUNK_RUNS].load(std::memory_order_relaxed)->ends[index % CONCURRENT_CHUNK_RUNS];
+  }
+
+/**
+ * @brief Get the number of runs in the snapshot.
+ *
+ * @return The number of runs.
+ */
+  std::int64_t ConcurrentSignal::Snapshot::getCount() const {
+    return count;
+  }
+
+/**
+ * @brief Get the run with the given index in O(1).
+ *
+ * @param index The index of the run.
+ * @return The run as a SignalState.
+ * @throw std::invalid_argument if the index is out of range.
+ */
+  SignalState ConcurrentSignal::Snapshot::getState(std::int64_t index) const {
+    if (index < 0 || index >= count){
+      throw std::invalid_argument("error: invalid index");
+    }
+    bool run_level = level != (index % 2 != 0);
+    if (index == count - 1){
+      return SignalState(run_level, last_time);
+    }
+    return SignalState(run_level, directory[index / CONCURRENT_CHUNK_RUNS].load(std::memory_order_relaxed)->times[index % CONCURRENT_CHUNK_RUNS]);
+  }
+
+/**
+ * @brief Finds the run covering the specified time in O(log n).
+ *
+ * @param time The time to look up.
+ * @return The index of the run covering the time.
+ * @throw std::invalid_argument if the time is negative or not less than the total time.
+ */
+  std::int64_t ConcurrentSignal::Snapshot::runIndexAt(std::int64_t time) const {
+    if (time < 0 || time >= total){
+      throw std::invalid_argument("error: invalid time");
+    }
+    std::int64_t low = 0, high = count - 1;
+    while (low < high){
+      std::int64_t middle = low + (high - low) / 2;
+      if (endOf(middle) > time){
+        high = middle;
+      }
+      else{
+        low = middle + 1;
+      }
+    }
+    return low;
+  }
+
+/**
+ * @brief Get the total time of the snapshot in O(1).
+ *
+ * @return The total time duration.
+ */
+  std::int64_t ConcurrentSignal::Snapshot::totalTime() const {
+    return total;
+  }
+
+/**
+ * @brief Accesses the signal level at a specified time.
+ *
+ * @param time The time at which to determine the signal level.
+ * @return The signal level (true for high, false for low) at the specified time.
+ * @throw std::invalid_argument if an invalid time is provided.
+ */
+  bool ConcurrentSignal::Snapshot::operator [](std::int64_t time) const {
+    return level != (runIndexAt(time) % 2 != 0);
+  }
+
+/**
+ * @brief Copies the runs of the snapshot into a BinarySignal.
+ *
+ * @return The BinarySignal with the same runs.
+ * @throw std::invalid_argument if the snapshot has more runs than a BinarySignal can hold.
+ */
+  BinarySignal ConcurrentSignal::Snapshot::toSignal() const {
+    if (count > std::numeric_limits<int>::max()){
+      throw std::invalid_argument("error: signal is too long");
+    }
+    BinarySignal result;
+    result.reserve((int)count);
+    for (std::int64_t i = 0; i < count; i++){
+      result += getState(i);
+    }
+    return result;
+  }
+
+}
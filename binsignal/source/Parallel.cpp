@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Parallel.h"
+
+namespace lab2{
+
+  namespace {
+
+    std::atomic<unsigned> thread_limit(0);
+
+    thread_local bool pool_worker = false;
+
+/**
+ * @brief Workers kept alive between parallelFor() calls, so a call does not start threads.
+ *
+ * One job runs at a time. The workers sleep on a condition variable until a job is posted,
+ * take chunks from a shared counter together with the calling thread and go back to sleep.
+ */
+    class ThreadPool {
+    public:
+      ~ThreadPool(){
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &worker : workers){
+          worker.join();
+        }
+      }
+
+      static ThreadPool &instance(){
+        static ThreadPool pool;
+        return pool;
+      }
+
+      bool run(std::size_t chunks, std::size_t threads, void (*call)(void *, std::size_t), void *context){
+        if (pool_worker){
+          return false;
+        }
+        std::unique_lock<std::mutex> job(submit, std::try_to_lock);
+        if (!job){
+          return false;
+        }
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          while (workers.size() + 1 < threads){
+            workers.emplace_back([this](){ serve(); });
+          }
+          this->call = call;
+          this->context = context;
+          this->chunks = chunks;
+          next = 0;
+          wanted = threads - 1;
+          joined = 0;
+          error = nullptr;
+          generation++;
+        }
+        wake.notify_all();
+        work();
+        std::exception_ptr failure;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          wanted = joined;
+          done.wait(lock, [this](){ return running == 0; });
+          failure = error;
+        }
+        if (failure){
+          std::rethrow_exception(failure);
+        }
+        return true;
+      }
+
+    private:
+      std::mutex submit;
+      std::mutex mutex;
+      std::condition_variable wake;
+      std::condition_variable done;
+      std::vector<std::thread> workers;
+      bool stopping = false;
+      std::uint64_t generation = 0;
+      void (*call)(void *, std::size_t) = nullptr;
+      void *context = nullptr;
+      std::size_t chunks = 0;
+      std::atomic<std::size_t> next{0};
+      std::size_t wanted = 0;
+      std::size_t joined = 0;
+      std::size_t running = 0;
+      std::exception_ptr error;
+
+      void work(){
+        try{
+          for (std::size_t k = next++; k < chunks; k = next++){
+            call(context, k);
+          }
+        }
+        catch (...){
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!error){
+            error = std::current_exception();
+          }
+          next = chunks;
+        }
+      }
+
+      void serve(){
+        pool_worker = true;
+        std::uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true){
+          wake.wait(lock, [this, seen](){ return stopping || (generation != seen && joined < wanted); });
+          if (stopping){
+            return;
+          }
+          seen = generation;
+          joined++;
+          running++;
+          lock.unlock();
+          work();
+          lock.lock();
+          if (--running == 0){
+            done.notify_all();
+          }
+        }
+      }
+    };
+
+  }
+
+/**
+ * @brief Get the number of threads used by the parallel algorithms.
+ *
+ * The number of hardware threads is queried once and cached.
+ *
+ * @return The limit set by setParallelThreads(), or the number of hardware threads by default.
+ */
+  unsigned parallelThreads(){
+    static const unsigned hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned threads = thread_limit.load(std::memory_order_relaxed);
+    return (threads == 0) ? hardware_threads : threads;
+  }
+
+/**
+ * @brief Limits the number of threads used by the parallel algorithms.
+ *
+ * @param threads The number of threads, 1 disables the parallel paths, 0 restores the default.
+ */
+  void setParallelThreads(unsigned threads){
+    thread_limit.store(threads, std::memory_order_relaxed);
+  }
+
+/**
+ * @brief Get the number of chunks to split a job of the given size into.
+ *
+ * Every chunk holds at least PARALLEL_MIN_CHUNK items, so small jobs run serially
+ * without looking at the thread limit.
+ *
+ * @param length The number of items.
+ * @return The number of chunks, 1 if the job should not be split.
+ */
+  std::size_t parallelChunks(std::size_t length){
+    if (length < 2 * (std::size_t)PARALLEL_MIN_CHUNK){
+      return 1;
+    }
+    std::size_t threads = parallelThreads();
+    if (threads <= 1){
+      return 1;
+    }
+    return std::max<std::size_t>(1, std::min<std::size_t>(threads * 4, length / PARALLEL_MIN_CHUNK));
+  }
+
+/**
+ * @brief Runs call(context, k) for every k in [0, chunks) on the calling thread and threads - 1 pool workers.
+ *
+ * The workers are started on first use and reused by later calls. Used by parallelFor().
+ *
+ * @param chunks The number of chunks.
+ * @param threads The number of threads to use, including the calling one.
+ * @param call The function processing one chunk.
+ * @param context The argument passed to call.
+ * @return false if the pool is busy or the call comes from a pool worker; nothing is run then.
+ */
+  bool parallelRun(std::size_t chunks, std::size_t threads, void (*call)(void *context, std::size_t chunk), void *context){
+    return ThreadPool::instance().run(chunks, threads, call, context);
+  }
+
+}
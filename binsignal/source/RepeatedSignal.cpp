@@ -0,0 +1,212 @@
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+#include "RenderSink.h"
+#include "RepeatedSignal.h"
+
+namespace lab2{
+
+/**
+ * @brief Constructs a signal that repeats a pattern without copying it.
+ *
+ * Only the pattern and the repeat count are stored, the runs of the repetitions are
+ * computed on access. The pattern gets a time index, so a time lookup takes O(log n).
+ *
+ * @param pattern The signal to repeat.
+ * @param repeats The number of repetitions.
+ * @throw std::invalid_argument if repeats is not positive.
+ * @throw std::overflow_error if the total time does not fit the time type.
+ */
+  RepeatedSignal::RepeatedSignal(const BinarySignal &pattern, std::int64_t repeats) : pattern(pattern), repeats(repeats), total(0) {
+    if (repeats <= 0){
+      throw std::invalid_argument("error: not positive number");
+    }
+    this->total = checkedMul(pattern.totalTime(), repeats);
+    checkedMul((std::int64_t)pattern.getCount(), repeats);
+    this->pattern.buildTimeIndex();
+  }
+
+/**
+ * @brief Get the repeated pattern.
+ *
+ * @return The pattern.
+ */
+  const BinarySignal &RepeatedSignal::getPattern() const {
+    return pattern;
+  }
+
+/**
+ * @brief Get the number of repetitions.
+ *
+ * @return The repeat count.
+ */
+  std::int64_t RepeatedSignal::getRepeats() const {
+    return repeats;
+  }
+
+/**
+ * @brief Get the number of runs of the repeated signal.
+ *
+ * When the first and the last run of the pattern have the same level, they are merged
+ * at every seam, so the signal has fewer runs than repeats * pattern runs.
+ *
+ * @return The number of runs.
+ */
+  std::int64_t RepeatedSignal::getCount() const {
+    std::int64_t runs = pattern.getCount();
+    if (runs <= 1){
+      return runs;
+    }
+    if (runs % 2 == 0){
+      return runs * repeats;
+    }
+    return (runs - 1) * repeats + 1;
+  }
+
+/**
+ * @brief Get the run with the given index.
+ *
+ * The run is computed from the pattern in O(1), a merged seam run has the time
+ * of the last and the first pattern run.
+ *
+ * @param index The index of the run.
+ * @return The run as a SignalState.
+ * @throw std::invalid_argument if the index is out of range.
+ */
+  SignalState RepeatedSignal::getState(std::int64_t index) const {
+    std::int64_t count = getCount();
+    if (index < 0 || index >= count){
+      throw std::invalid_argument("error: invalid index");
+    }
+    int runs = pattern.getCount();
+    if (runs == 1){
+      return SignalState(pattern.getState(0).getLevel(), total);
+    }
+    if (runs % 2 == 0){
+      return pattern.getState((int)(index % runs));
+    }
+    if (index == count - 1){
+      return pattern.getState(runs - 1);
+    }
+    int run = (int)(index % (runs - 1));
+    SignalState state = pattern.getState(run);
+    if (run == 0 && index != 0){
+      state.elongateSignal(pattern.getState(runs - 1).getTime());
+    }
+    return state;
+  }
+
+/**
+ * @brief Finds the run covering the specified time.
+ *
+ * @param time The time to look up.
+ * @return The index of the run covering the time, as counted by getState().
+ * @throw std::invalid_argument if the time is negative or not less than the total time.
+ */
+  std::int64_t RepeatedSignal::runIndexAt(std::int64_t time) const {
+    if (time < 0 || time >= total){
+      throw std::invalid_argument("error: invalid time");
+    }
+    std::int64_t runs = pattern.getCount();
+    std::int64_t block = time / pattern.totalTime();
+    std::int64_t run = pattern.runIndexAt(time % pattern.totalTime());
+    if (runs == 1){
+      return 0;
+    }
+    if (runs % 2 == 0){
+      return block * runs + run;
+    }
+    if (run == runs - 1 && block != repeats - 1){
+      return (block + 1) * (runs - 1);
+    }
+    return block * (runs - 1) + run;
+  }
+
+/**
+ * @brief Get the total time of the repeated signal.
+ *
+ * @return The total time duration.
+ */
+  std::int64_t RepeatedSignal::totalTime() const {
+    return total;
+  }
+
+/**
+ * @brief Accesses the signal level at a specified time.
+ *
+ * @param time The time at which to determine the signal level.
+ * @return The signal level (true for high, false for low) at the specified time.
+ * @throw std::invalid_argument if an invalid time is provided.
+ */
+  bool RepeatedSignal::operator [](std::int64_t time) const {
+    if (time < 0 || time >= total){
+      throw std::invalid_argument("error: invalid time");
+    }
+    return pattern.getState(pattern.runIndexAt(time % pattern.totalTime())).getLevel();
+  }
+
+/**
+ * @brief Get the range of level changes of the repeated signal.
+ *
+ * The edges are produced lazily from the runs of the pattern, the seam runs are merged,
+ * so no edge is reported where the last and the first pattern run have the same level.
+ *
+ * @param kind EDGE_ANY, EDGE_RISING or EDGE_FALLING.
+ * @return The range of edges ordered by time, valid while the RepeatedSignal exists.
+ * @throw std::invalid_argument if kind is not a valid edge kind.
+ */
+  RepeatedEdgeRange RepeatedSignal::edges(int kind) const {
+    if (kind != EDGE_ANY && kind != EDGE_RISING && kind != EDGE_FALLING){
+      throw std::invalid_argument("error: invalid edge kind");
+    }
+    return RepeatedEdgeRange(*this, kind);
+  }
+
+/**
+ * @brief Expands the repetitions into a BinarySignal.
+ *
+ * @return The BinarySignal with all runs stored.
+ * @throw std::invalid_argument if the signal has more runs than a BinarySignal can hold.
+ */
+  BinarySignal RepeatedSignal::materialize() const {
+    if (repeats > std::numeric_limits<int>::max()){
+      throw std::invalid_argument("error: signal is too long");
+    }
+    return pattern * (int)repeats;
+  }
+
+/**
+ * @brief Convert the repeated signal to a string of '0' and '1' characters.
+ *
+ * @return A string representation of the signal.
+ */
+  std::string RepeatedSignal::toString() const {
+    std::string result(total, '\0');
+    BufferSink sink(result.data());
+    for (std::int64_t k = 0; k < repeats; k++){
+      for (int i = 0; i < pattern.getCount(); i++){
+        SignalState state = pattern.getState(i);
+        sink.put(state.getLevel() ? '1' : '0', state.getTime());
+      }
+    }
+    return result;
+  }
+
+/**
+ * @brief Writes the '0'/'1' form of the repeated signal to an output stream in fixed-size chunks.
+ *
+ * @param output The output stream to write to.
+ */
+  void RepeatedSignal::write(std::ostream &output) const {
+    StreamSink sink(output);
+    for (std::int64_t k = 0; k < repeats; k++){
+      for (int i = 0; i < pattern.getCount(); i++){
+        SignalState state = pattern.getState(i);
+        sink.put(state.getLevel() ? '1' : '0', state.getTime());
+      }
+    }
+    sink.flush();
+  }
+
+}
@@ -0,0 +1,418 @@
+#include <atomic>
+#include <bit>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SAMPLE_SCAN_X86
+#endif
+
+#include "SampleScan.h"
+
+namespace lab2{
+
+  namespace {
+
+    struct ScanKernels {
+      const char *name;
+      std::size_t (*count_bytes)(const std::uint8_t *data, std::size_t length);
+      std::size_t (*find_bytes)(const std::uint8_t *data, std::size_t length, std::size_t from, bool level);
+      std::size_t (*count_ints)(const int *data, std::size_t length);
+      std::size_t (*find_ints)(const int *data, std::size_t length, std::size_t from, bool level);
+    };
+
+/**
+ * @brief Counts level changes between neighbouring byte samples starting from the given position.
+ */
+    std::size_t countBytesFrom(const std::uint8_t *data, std::size_t length, std::size_t from){
+      std::size_t transitions = 0;
+      for (std::size_t i = from; i + 1 < length; i++){
+        transitions += ((data[i] != 0) != (data[i + 1] != 0));
+      }
+      return transitions;
+    }
+
+/**
+ * @brief Finds the first byte sample whose level differs from the given one.
+ */
+    std::size_t findBytesScalar(const std::uint8_t *data, std::size_t length, std::size_t from, bool level){
+      std::size_t i = from;
+      while (i < length && (data[i] != 0) == level){
+        i++;
+      }
+      return i;
+    }
+
+    std::size_t countBytesScalar(const std::uint8_t *data, std::size_t length){
+      return countBytesFrom(data, length, 0);
+    }
+
+/**
+ * @brief Counts level changes between neighbouring int samples starting from the given position.
+ */
+    std::size_t countIntsFrom(const int *data, std::size_t length, std::size_t from){
+      std::size_t transitions = 0;
+      for (std::size_t i = from; i + 1 < length; i++){
+        transitions += ((data[i] != 0) != (data[i + 1] != 0));
+      }
+      return transitions;
+    }
+
+/**
+ * @brief Finds the first int sample whose level differs from the given one.
+ */
+    std::size_t findIntsScalar(const int *data, std::size_t length, std::size_t from, bool level){
+      std::size_t i = from;
+      while (i < length && (data[i] != 0) == level){
+        i++;
+      }
+      return i;
+    }
+
+    std::size_t countIntsScalar(const int *data, std::size_t length){
+      return countIntsFrom(data, length, 0);
+    }
+
+#ifdef SAMPLE_SCAN_X86
+
+/**
+ * @brief SSE2 variant of countBytesScalar(), compares 16 samples with their right neighbours per step.
+ */
+    __attribute__((target("sse2")))
+    std::size_t countBytesSse2(const std::uint8_t *data, std::size_t length){
+      const __m128i zero = _mm_setzero_si128();
+      std::size_t transitions = 0;
+      std::size_t i = 0;
+      for (; i + 17 <= length; i += 16){
+        __m128i current = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i next = _mm_loadu_si128((const __m128i *)(data + i + 1));
+        unsigned zeros = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(current, zero));
+        unsigned next_zeros = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(next, zero));
+        transitions += std::popcount(zeros ^ next_zeros);
+      }
+      return transitions + countBytesFrom(data, length, i);
+    }
+
+/**
+ * @brief SSE2 variant of findBytesScalar(), tests 16 samples per step.
+ */
+    __attribute__((target("sse2")))
+    std::size_t findBytesSse2(const std::uint8_t *data, std::size_t length, std::size_t from, bool level){
+      const __m128i zero = _mm_setzero_si128();
+      std::size_t i = from;
+      for (; i + 16 <= length; i += 16){
+        unsigned zeros = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(data + i)), zero));
+        unsigned diff = level ? zeros : (~zeros & 0xFFFFu);
+        if (diff){
+          return i + std::countr_zero(diff);
+        }
+      }
+      return findBytesScalar(data, length, i, level);
+    }
+
+/**
+ * @brief SSE2 variant of countIntsScalar(), compares 4 samples with their right neighbours per step.
+ */
+    __attribute__((target("sse2")))
+    std::size_t countIntsSse2(const int *data, std::size_t length){
+      const __m128i zero = _mm_setzero_si128();
+      std::size_t transitions = 0;
+      std::size_t i = 0;
+      for (; i + 5 <= length; i += 4){
+        __m128i current = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i next = _mm_loadu_si128((const __m128i *)(data + i + 1));
+        unsigned zeros = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(current, zero)));
+        unsigned next_zeros = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(next, zero)));
+        transitions += std::popcount(zeros ^ next_zeros);
+      }
+      return transitions + countIntsFrom(data, length, i);
+    }
+
+/**
+ * @brief SSE2 variant of findIntsScalar(), tests 4 samples per step.
+ */
+    __attribute__((target("sse2")))
+    std::size_t findIntsSse2(const int *data, std::size_t length, std::size_t from, bool level){
+      const __m128i zero = _mm_setzero_si128();
+      std::size_t i = from;
+      for (; i + 4 <= length; i += 4){
+        __m128i current = _mm_loadu_si128((const __m128i *)(data + i));
+        unsigned zeros = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(current, zero)));
+        unsigned diff = level ? zeros : (~zeros & 0xFu);
+        if (diff){
+          return i + std::countr_zero(diff);
+        }
+      }
+      return findIntsScalar(data, length, i, level);
+    }
+
+/**
+ * @brief AVX2 variant of countBytesScalar(), compares 32 samples with their right neighbours per step.
+ */
+    __attribute__((target("avx2,popcnt")))
+    std::size_t countBytesAvx2(const std::uint8_t *data, std::size_t length){
+      const __m256i zero = _mm256_setzero_si256();
+      std::size_t transitions = 0;
+      std::size_t i = 0;
+      for (; i + 33 <= length; i += 32){
+        __m256i current = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i next = _mm256_loadu_si256((const __m256i *)(data + i + 1));
+        unsigned zeros = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(current, zero));
+        unsigned next_zeros = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(next, zero));
+        transitions += std::popcount(zeros ^ next_zeros);
+      }
+      return transitions + countBytesFrom(data, length, i);
+    }
+
+/**
+ * @brief AVX2 variant of findBytesScalar(), tests 32 samples per step.
+ */
+    __attribute__((target("avx2,bmi")))
+    std::size_t findBytesAvx2(const std::uint8_t *data, std::size_t length, std::size_t from, bool level){
+      const __m256i zero = _mm256_setzero_si256();
+      std::size_t i = from;
+      for (; i + 32 <= length; i += 32){
+        unsigned zeros = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(data + i)), zero));
+        unsigned diff = level ? zeros : ~zeros;
+        if (diff){
+          return i + std::countr_zero(diff);
+        }
+      }
+      return findBytesScalar(data, length, i, level);
+    }
+
+/**
+ * @brief AVX2 variant of countIntsScalar(), compares 8 samples with their right neighbours per step.
+ */
+    __attribute__((target("avx2,popcnt")))
+    std::size_t countIntsAvx2(const int *data, std::size_t length){
+      const __m256i zero = _mm256_setzero_si256();
+      std::size_t transitions = 0;
+      std::size_t i = 0;
+      for (; i + 9 <= length; i += 8){
+        __m256i current = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i next = _mm256_loadu_si256((const __m256i *)(data + i + 1));
+        unsigned zeros = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(current, zero)));
+        unsigned next_zeros = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(next, zero)));
+        transitions += std::popcount(zeros ^ next_zeros);
+      }
+      return transitions + countIntsFrom(data, length, i);
+    }
+
+/**
+ * @brief AVX2 variant of findIntsScalar(), tests 8 samples per step.
+ */
+    __attribute__((target("avx2,bmi")))
+    std::size_t findIntsAvx2(const int *data, std::size_t length, std::size_t from, bool level){
+      const __m256i zero = _mm256_setzero_si256();
+      std::size_t i = from;
+      for (; i + 8 <= length; i += 8){
+        __m256i current = _mm256_loadu_si256((const __m256i *)(data + i));
+        unsigned zeros = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(current, zero)));
+        unsigned diff = level ? zeros : (~zeros & 0xFFu);
+        if (diff){
+          return i + std::countr_zero(diff);
+        }
+      }
+      return findIntsScalar(data, length, i, level);
+    }
+
+#endif
+
+    const ScanKernels SCALAR_KERNELS = {"scalar", countBytesScalar, findBytesScalar, countIntsScalar, findIntsScalar};
+#ifdef SAMPLE_SCAN_X86
+    const ScanKernels SSE2_KERNELS = {"sse2", countBytesSse2, findBytesSse2, countIntsSse2, findIntsSse2};
+    const ScanKernels AVX2_KERNELS = {"avx2", countBytesAvx2, findBytesAvx2, countIntsAvx2, findIntsAvx2};
+#endif
+
+/**
+ * @brief Checks whether the processor is able to run the kernels with the given name.
+ */
+    bool kernelSupported(const ScanKernels &candidate){
+#ifdef SAMPLE_SCAN_X86
+      __builtin_cpu_init();
+      if (&candidate == &AVX2_KERNELS){
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt") && __builtin_cpu_supports("bmi");
+      }
+      if (&candidate == &SSE2_KERNELS){
+        return __builtin_cpu_supports("sse2");
+      }
+#endif
+      return &candidate == &SCALAR_KERNELS;
+    }
+
+/**
+ * @brief Picks the widest kernels supported by the processor.
+ */
+    const ScanKernels *selectKernels(){
+#ifdef SAMPLE_SCAN_X86
+      if (kernelSupported(AVX2_KERNELS)){
+        return &AVX2_KERNELS;
+      }
+      if (kernelSupported(SSE2_KERNELS)){
+        return &SSE2_KERNELS;
+      }
+#endif
+      return &SCALAR_KERNELS;
+    }
+
+    std::atomic<const ScanKernels *> active_kernels(nullptr);
+
+/**
+ * @brief Get the kernels in use, selecting them on the first call.
+ *
+ * The pointer is constant-initialized, so the call is safe from static initializers
+ * of other translation units. Threads racing on the first call select the same kernels,
+ * and a choice made by setSampleScanKernel() in the meantime is kept.
+ */
+    const ScanKernels *kernels(){
+      const ScanKernels *current = active_kernels.load(std::memory_order_acquire);
+      if (!current){
+        const ScanKernels *selected = selectKernels();
+        if (active_kernels.compare_exchange_strong(current, selected, std::memory_order_acq_rel)){
+          current = selected;
+        }
+      }
+      return current;
+    }
+
+  }
+
+/**
+ * @brief Counts the level changes in a buffer of byte samples.
+ *
+ * A sample is high when it is not zero.
+ *
+ * @param data Pointer to the samples.
+ * @param length The number of samples.
+ * @return The number of positions where a sample differs in level from the next one.
+ */
+  std::size_t countByteTransitions(const std::uint8_t *data, std::size_t length){
+    return kernels()->count_bytes(data, length);
+  }
+
+/**
+ * @brief Finds the first byte sample that differs from the given level.
+ *
+ * @param data Pointer to the samples.
+ * @param length The number of samples.
+ * @param from The position to start from.
+ * @param level The level of the current run.
+ * @return The position of the first sample with another level or length if there is none.
+ */
+  std::size_t findByteTransition(const std::uint8_t *data, std::size_t length, std::size_t from, bool level){
+    return kernels()->find_bytes(data, length, from, level);
+  }
+
+/**
+ * @brief Counts the level changes in a buffer of int samples.
+ *
+ * A sample is high when it is not zero.
+ *
+ * @param data Pointer to the samples.
+ * @param length The number of samples.
+ * @return The number of positions where a sample differs in level from the next one.
+ */
+  std::size_t countIntTransitions(const int *data, std::size_t length){
+    return kernels()->count_ints(data, length);
+  }
+
+/**
+ * @brief Finds the first int sample that differs from the given level.
+ *
+ * @param data Pointer to the samples.
+ * @param length The number of samples.
+ * @param from The position to start from.
+ * @param level The level of the current run.
+ * @return The position of the first sample with another level or length if there is none.
+ */
+  std::size_t findIntTransition(const int *data, std::size_t length, std::size_t from, bool level){
+    return kernels()->find_ints(data, length, from, level);
+  }
+
+/**
+ * @brief Counts the level changes in a packed bitset.
+ *
+ * Sample i is bit i % 64 of word i / 64. Every word is compared with itself shifted by one sample,
+ * so 64 samples are processed per step without SIMD instructions.
+ *
+ * @param bits Pointer to the packed samples.
+ * @param bit_count The number of samples.
+ * @return The number of positions where a sample differs in level from the next one.
+ */
+  std::size_t countBitTransitions(const std::uint64_t *bits, std::size_t bit_count){
+    if (bit_count < 2){
+      return 0;
+    }
+    std::size_t words = (bit_count + 63) / 64;
+    std::size_t transitions = 0;
+    for (std::size_t k = 0; k < words; k++){
+      std::uint64_t next = (k + 1 < words) ? bits[k + 1] : 0;
+      std::uint64_t diff = bits[k] ^ ((bits[k] >> 1) | (next << 63));
+      std::size_t pairs = bit_count - 1 - 64 * k;
+      if (pairs < 64){
+        diff &= (std::uint64_t(1) << pairs) - 1;
+      }
+      transitions += std::popcount(diff);
+    }
+    return transitions;
+  }
+
+/**
+ * @brief Finds the first sample in a packed bitset that differs from the given level.
+ *
+ * @param bits Pointer to the packed samples.
+ * @param bit_count The number of samples.
+ * @param from The position to start from.
+ * @param level The level of the current run.
+ * @return The position of the first sample with another level or bit_count if there is none.
+ */
+  std::size_t findBitTransition(const std::uint64_t *bits, std::size_t bit_count, std::size_t from, bool level){
+    std::size_t i = from;
+    while (i < bit_count){
+      std::uint64_t diff = (bits[i / 64] ^ (level ? ~std::uint64_t(0) : 0)) >> (i % 64);
+      if (diff){
+        i += std::countr_zero(diff);
+        return (i < bit_count) ? i : bit_count;
+      }
+      i = (i / 64 + 1) * 64;
+    }
+    return bit_count;
+  }
+
+/**
+ * @brief Get the name of the kernels used for byte and int samples.
+ *
+ * The kernels are chosen on first use according to the processor features.
+ *
+ * @return "avx2", "sse2" or "scalar".
+ */
+  const char *sampleScanKernel(){
+    return kernels()->name;
+  }
+
+/**
+ * @brief Forces the kernels used for byte and int samples.
+ *
+ * Intended for tests and benchmarks, must not be called while samples are being encoded.
+ *
+ * @param name "avx2", "sse2" or "scalar".
+ * @return true if the kernels are supported by the processor and have been selected.
+ */
+  bool setSampleScanKernel(const char *name){
+    const ScanKernels *candidates[] = {
+#ifdef SAMPLE_SCAN_X86
+      &AVX2_KERNELS, &SSE2_KERNELS,
+#endif
+      &SCALAR_KERNELS
+    };
+    for (const ScanKernels *candidate : candidates){
+      if (std::strcmp(candidate->name, name) == 0 && kernelSupported(*candidate)){
+        active_kernels.store(candidate, std::memory_order_release);
+        return true;
+      }
+    }
+    return false;
+  }
+
+}
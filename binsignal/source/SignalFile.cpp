@@ -0,0 +1,77 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "SignalFile.h"
+
+namespace lab2{
+
+/**
+ * @brief Maps a file saved by BinarySignal::save() into memory for reading.
+ *
+ * The file is mapped read-only, its pages are loaded by the system on access.
+ *
+ * @param path The path to the file.
+ * @throw std::runtime_error if the file can not be opened or mapped.
+ */
+  SignalFile::SignalFile(const std::string &path) : data(nullptr), size(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0){
+      throw std::runtime_error(std::string("failed to open signal file: ") + strerror(errno));
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0){
+      int error = errno;
+      close(fd);
+      throw std::runtime_error(std::string("failed to open signal file: ") + strerror(error));
+    }
+    this->size = (std::size_t)info.st_size;
+    if (size != 0){
+      void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped == MAP_FAILED){
+        int error = errno;
+        close(fd);
+        throw std::runtime_error(std::string("failed to map signal file: ") + strerror(error));
+      }
+      this->data = mapped;
+    }
+    close(fd);
+  }
+
+/**
+ * @brief Unmaps the file. Views obtained from it become invalid.
+ */
+  SignalFile::~SignalFile(){
+    if (data){
+      munmap(data, size);
+    }
+  }
+
+/**
+ * @brief Get the size of the mapped file.
+ *
+ * @return The size in bytes.
+ */
+  std::size_t SignalFile::getSize() const {
+    return size;
+  }
+
+/**
+ * @brief Creates a zero-copy view over the mapped signal.
+ *
+ * The runs are checked against the header unless validate is false, see BinarySignalView.
+ *
+ * @param validate Whether to check the runs and the time index against the header.
+ * @return The view, valid while the SignalFile exists.
+ * @throw std::invalid_argument if the file does not hold a valid signal in the fixed-width encoding.
+ */
+  BinarySignalView SignalFile::view(bool validate) const {
+    return BinarySignalView(data, size, validate);
+  }
+
+}
@@ -0,0 +1,452 @@
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+#include "RenderSink.h"
+#include "SignalRope.h"
+
+namespace lab2{
+
+  namespace {
+
+/**
+ * @brief Returns a random number for choosing the root of merged subtrees.
+ */
+    std::uint64_t nextRandom(){
+      static thread_local std::mt19937_64 engine(0x5eed);
+      return engine();
+    }
+
+  }
+
+/**
+ * @brief Constructs an immutable chunk of alternating runs.
+ *
+ * @throw std::overflow_error if the chunk time does not fit the time type.
+ */
+  SignalRope::Chunk::Chunk(bool level, const std::int64_t *times, std::size_t n) : level(level), total(0), times(times, times + n) {
+    for (std::int64_t time : this->times){
+      total = checkedAdd(total, time);
+    }
+  }
+
+/**
+ * @brief Constructs an immutable rope node and its subtree totals.
+ *
+ * @throw std::overflow_error if the subtree time does not fit the time type.
+ */
+  SignalRope::Node::Node(ChunkPtr chunk, NodePtr left, NodePtr right) :
+    chunk(std::move(chunk)), runs((std::int64_t)this->chunk->times.size() + runsOf(left) + runsOf(right)),
+    total(checkedAdd(checkedAdd(this->chunk->total, totalOf(left)), totalOf(right))),
+    left(std::move(left)), right(std::move(right)) {}
+
+  std::int64_t SignalRope::runsOf(const NodePtr &node){
+    return node ? node->runs : 0;
+  }
+
+  std::int64_t SignalRope::totalOf(const NodePtr &node){
+    return node ? node->total : 0;
+  }
+
+/**
+ * @brief Creates a single node holding n runs starting with the given level, or nullptr if n is 0.
+ */
+  SignalRope::NodePtr SignalRope::leaf(bool level, const std::int64_t *times, std::size_t n){
+    if (n == 0){
+      return nullptr;
+    }
+    return std::make_shared<const Node>(std::make_shared<const Chunk>(level, times, n), nullptr, nullptr);
+  }
+
+/**
+ * @brief Builds a balanced subtree over the chunks [from, to).
+ */
+  SignalRope::NodePtr SignalRope::build(const std::vector<ChunkPtr> &chunks, std::size_t from, std::size_t to){
+    if (from >= to){
+      return nullptr;
+    }
+    std::size_t middle = from + (to - from) / 2;
+    return std::make_shared<const Node>(chunks[middle], build(chunks, from, middle), build(chunks, middle + 1, to));
+  }
+
+/**
+ * @brief Concatenates two subtrees without looking at the seam.
+ *
+ * The root is taken from each side with a probability proportional to its size,
+ * which keeps the expected depth logarithmic. Only the nodes on the merge path are new,
+ * the chunks are shared.
+ */
+  SignalRope::NodePtr SignalRope::merge(const NodePtr &left, const NodePtr &right){
+    if (!left){
+      return right;
+    }
+    if (!right){
+      return left;
+    }
+    if (nextRandom() % (std::uint64_t)(left->runs + right->runs) < (std::uint64_t)left->runs){
+      return std::make_shared<const Node>(left->chunk, left->left, merge(left->right, right));
+    }
+    return std::make_shared<const Node>(right->chunk, merge(left, right->left), right->right);
+  }
+
+/**
+ * @brief Concatenates two subtrees, fusing the chunks at the seam when needed.
+ *
+ * The seam runs are merged when their levels are equal. The seam chunks are also fused
+ * when they fit into ROPE_CHUNK_RUNS runs together, so repeated edits do not leave
+ * the rope fragmented into tiny chunks.
+ */
+  SignalRope::NodePtr SignalRope::join(const NodePtr &left, const NodePtr &right){
+    if (!left || !right){
+      return merge(left, right);
+    }
+    const Node *last = left.get();
+    while (last->right){
+      last = last->right.get();
+    }
+    const Node *first = right.get();
+    while (first->left){
+      first = first->left.get();
+    }
+    const Chunk &tail = *last->chunk;
+    const Chunk &head = *first->chunk;
+    bool same = (tail.level != ((tail.times.size() - 1) % 2 != 0)) == head.level;
+    if (!same && tail.times.size() + head.times.size() > ROPE_CHUNK_RUNS){
+      return merge(left, right);
+    }
+    std::vector<std::int64_t> times(tail.times);
+    if (same){
+      times.back() = checkedAdd(times.back(), head.times[0]);
+      times.insert(times.end(), head.times.begin() + 1, head.times.end());
+    }
+    else{
+      times.insert(times.end(), head.times.begin(), head.times.end());
+    }
+    NodePtr before, after, dummy, seam;
+    splitRuns(left, left->runs - (std::int64_t)tail.times.size(), before, dummy);
+    splitRuns(right, (std::int64_t)head.times.size(), dummy, after);
+    if (times.size() <= ROPE_CHUNK_RUNS){
+      seam = leaf(tail.level, times.data(), times.size());
+    }
+    else{
+      std::size_t half = times.size() / 2;
+      seam = merge(leaf(tail.level, times.data(), half), leaf(tail.level != (half % 2 != 0), times.data() + half, times.size() - half));
+    }
+    return merge(merge(before, seam), after);
+  }
+
+/**
+ * @brief Splits a subtree into its first runs runs and the rest, cutting a chunk if needed.
+ */
+  void SignalRope::splitRuns(const NodePtr &node, std::int64_t runs, NodePtr &left, NodePtr &right){
+    if (!node){
+      left = right = nullptr;
+      return;
+    }
+    NodePtr part;
+    const Chunk &chunk = *node->chunk;
+    std::int64_t before = runsOf(node->left);
+    std::int64_t size = (std::int64_t)chunk.times.size();
+    if (runs <= before){
+      splitRuns(node->left, runs, left, part);
+      right = std::make_shared<const Node>(node->chunk, part, node->right);
+    }
+    else if (runs >= before + size){
+      splitRuns(node->right, runs - before - size, part, right);
+      left = std::make_shared<const Node>(node->chunk, node->left, part);
+    }
+    else{
+      std::size_t cut = (std::size_t)(runs - before);
+      left = merge(node->left, leaf(chunk.level, chunk.times.data(), cut));
+      right = merge(leaf(chunk.level != (cut % 2 != 0), chunk.times.data() + cut, chunk.times.size() - cut), node->right);
+    }
+  }
+
+/**
+ * @brief Splits a subtree into the time [0, time) and the rest, cutting the run that covers time.
+ */
+  void SignalRope::splitTime(const NodePtr &node, std::int64_t time, NodePtr &left, NodePtr &right){
+    if (!node){
+      left = right = nullptr;
+      return;
+    }
+    NodePtr part;
+    const Chunk &chunk = *node->chunk;
+    std::int64_t before = totalOf(node->left);
+    if (time <= before){
+      splitTime(node->left, time, left, part);
+      right = std::make_shared<const Node>(node->chunk, part, node->right);
+    }
+    else if (time >= before + chunk.total){
+      splitTime(node->right, time - before - chunk.total, part, right);
+      left = std::make_shared<const Node>(node->chunk, node->left, part);
+    }
+    else{
+      std::int64_t head = time - before;
+      std::size_t run = 0;
+      while (head >= chunk.times[run]){
+        head -= chunk.times[run];
+        run++;
+      }
+      std::vector<std::int64_t> first(chunk.times.begin(), chunk.times.begin() + run);
+      std::vector<std::int64_t> rest(chunk.times.begin() + run, chunk.times.end());
+      if (head != 0){
+        first.push_back(head);
+        rest[0] -= head;
+      }
+      left = merge(node->left, leaf(chunk.level, first.data(), first.size()));
+      right = merge(leaf(chunk.level != (run % 2 != 0), rest.data(), rest.size()), node->right);
+    }
+  }
+
+/**
+ * @brief Calls visit(level, time) for every run of a subtree in order.
+ */
+  template <class Visit>
+  void SignalRope::forEach(const NodePtr &node, Visit &visit){
+    if (!node){
+      return;
+    }
+    forEach(node->left, visit);
+    const Chunk &chunk = *node->chunk;
+    for (std::size_t i = 0; i < chunk.times.size(); i++){
+      visit(chunk.level != (i % 2 != 0), chunk.times[i]);
+    }
+    forEach(node->right, visit);
+  }
+
+/**
+ * @brief Constructs a rope holding the runs of a BinarySignal.
+ *
+ * The runs are cut into chunks of ROPE_CHUNK_RUNS runs, so the rope stores about
+ * the same 8 bytes per run as the signal, and the tree is built balanced in O(n).
+ * Copies of the rope share all nodes and chunks, an edit creates only the O(log n)
+ * nodes on its path and at most a few chunks at the cut, so the copies never see each other's changes.
+ *
+ * @param signal The signal to copy.
+ */
+  SignalRope::SignalRope(const BinarySignal &signal){
+    std::vector<ChunkPtr> chunks;
+    std::vector<std::int64_t> times;
+    times.reserve(ROPE_CHUNK_RUNS);
+    for (int from = 0; from < signal.getCount(); from += ROPE_CHUNK_RUNS){
+      int to = std::min(signal.getCount(), from + ROPE_CHUNK_RUNS);
+      times.clear();
+      for (int i = from; i < to; i++){
+        times.push_back(signal.getState(i).getTime());
+      }
+      chunks.push_back(std::make_shared<const Chunk>(signal.getState(from).getLevel(), times.data(), times.size()));
+    }
+    root = build(chunks, 0, chunks.size());
+  }
+
+/**
+ * @brief Get the number of runs in the rope.
+ *
+ * @return The number of runs.
+ */
+  std::int64_t SignalRope::getCount() const {
+    return runsOf(root);
+  }
+
+/**
+ * @brief Get the run with the given index in O(log n).
+ *
+ * @param index The index of the run.
+ * @return The run as a SignalState.
+ * @throw std::invalid_argument if the index is out of range.
+ */
+  SignalState SignalRope::getState(std::int64_t index) const {
+    if (index < 0 || index >= getCount()){
+      throw std::invalid_argument("error: invalid index");
+    }
+    const Node *node = root.get();
+    while (true){
+      std::int64_t before = runsOf(node->left);
+      std::int64_t size = (std::int64_t)node->chunk->times.size();
+      if (index < before){
+        node = node->left.get();
+      }
+      else if (index < before + size){
+        std::int64_t run = index - before;
+        return SignalState(node->chunk->level != (run % 2 != 0), node->chunk->times[run]);
+      }
+      else{
+        index -= before + size;
+        node = node->right.get();
+      }
+    }
+  }
+
+/**
+ * @brief Finds the run covering the specified time in O(log n), plus a scan of one chunk.
+ *
+ * @param time The time to look up.
+ * @return The index of the run covering the time.
+ * @throw std::invalid_argument if the time is negative or not less than the total time.
+ */
+  std::int64_t SignalRope::runIndexAt(std::int64_t time) const {
+    if (time < 0 || time >= totalTime()){
+      throw std::invalid_argument("error: invalid time");
+    }
+    std::int64_t index = 0;
+    const Node *node = root.get();
+    while (true){
+      std::int64_t before = totalOf(node->left);
+      const Chunk &chunk = *node->chunk;
+      if (time < before){
+        node = node->left.get();
+      }
+      else if (time < before + chunk.total){
+        time -= before;
+        index += runsOf(node->left);
+        for (std::int64_t run : chunk.times){
+          if (time < run){
+            return index;
+          }
+          time -= run;
+          index++;
+        }
+      }
+      else{
+        time -= before + chunk.total;
+        index += runsOf(node->left) + (std::int64_t)chunk.times.size();
+        node = node->right.get();
+      }
+    }
+  }
+
+/**
+ * @brief Get the total time of the rope in O(1).
+ *
+ * @return The total time duration.
+ */
+  std::int64_t SignalRope::totalTime() const {
+    return totalOf(root);
+  }
+
+/**
+ * @brief Accesses the signal level at a specified time in O(log n).
+ *
+ * @param time The time at which to determine the signal level.
+ * @return The signal level (true for high, false for low) at the specified time.
+ * @throw std::invalid_argument if an invalid time is provided.
+ */
+  bool SignalRope::operator [](std::int64_t time) const {
+    return getState(runIndexAt(time)).getLevel();
+  }
+
+/**
+ * @brief Appends another rope in O(log n), sharing its nodes.
+ *
+ * @param other The rope to append.
+ * @return A reference to the modified rope.
+ * @throw std::overflow_error if the total time does not fit the time type.
+ */
+  SignalRope &SignalRope::operator +=(const SignalRope &other){
+    root = join(root, other.root);
+    return *this;
+  }
+
+/**
+ * @brief Inserts another rope at the specified time in O(log n).
+ *
+ * @param other The rope to be inserted.
+ * @param time The time at which to insert the other rope.
+ * @return A reference to the modified rope.
+ * @throw std::invalid_argument if the time is negative or greater than the total time.
+ * @throw std::overflow_error if the total time does not fit the time type.
+ */
+  SignalRope &SignalRope::insertSignal(const SignalRope &other, std::int64_t time){
+    if (time < 0 || totalTime() < time){
+      throw std::invalid_argument("error: invalid insertion time");
+    }
+    checkedAdd(totalTime(), other.totalTime());
+    NodePtr left, right;
+    splitTime(root, time, left, right);
+    root = join(join(left, other.root), right);
+    return *this;
+  }
+
+/**
+ * @brief Removes a segment of the signal in O(log n).
+ *
+ * @param time The starting time of the segment to be removed.
+ * @param duration The duration of the segment to be removed.
+ * @return A reference to the modified rope.
+ * @throw std::invalid_argument if the segment is not inside the signal.
+ */
+  SignalRope &SignalRope::removeSignal(std::int64_t time, std::int64_t duration){
+    if (time < 0 || duration < 0 || totalTime() < time || totalTime() - time < duration){
+      throw std::invalid_argument("error: invalid time");
+    }
+    NodePtr left, rest, middle, right;
+    splitTime(root, time, left, rest);
+    splitTime(rest, duration, middle, right);
+    root = join(left, right);
+    return *this;
+  }
+
+/**
+ * @brief Get a segment of the signal in O(log n), sharing the nodes with this rope.
+ *
+ * @param time The starting time of the segment.
+ * @param duration The duration of the segment.
+ * @return The rope holding the segment.
+ * @throw std::invalid_argument if the segment is not inside the signal.
+ */
+  SignalRope SignalRope::slice(std::int64_t time, std::int64_t duration) const {
+    if (time < 0 || duration < 0 || totalTime() < time || totalTime() - time < duration){
+      throw std::invalid_argument("error: invalid time");
+    }
+    NodePtr left, rest, middle, right;
+    splitTime(root, time, left, rest);
+    splitTime(rest, duration, middle, right);
+    return SignalRope(middle);
+  }
+
+/**
+ * @brief Copies the runs into a BinarySignal.
+ *
+ * @return The BinarySignal with the same runs.
+ * @throw std::invalid_argument if the rope has more runs than a BinarySignal can hold.
+ */
+  BinarySignal SignalRope::toSignal() const {
+    if (getCount() > std::numeric_limits<int>::max()){
+      throw std::invalid_argument("error: signal is too long");
+    }
+    BinarySignal result;
+    result.reserve((int)getCount());
+    auto visit = [&result](bool level, std::int64_t time){ result += SignalState(level, time); };
+    forEach(root, visit);
+    return result;
+  }
+
+/**
+ * @brief Convert the rope to a string of '0' and '1' characters.
+ *
+ * @return A string representation of the signal.
+ */
+  std::string SignalRope::toString() const {
+    std::string result(totalTime(), '\0');
+    BufferSink sink(result.data());
+    auto visit = [&sink](bool level, std::int64_t time){ sink.put(level ? '1' : '0', time); };
+    forEach(root, visit);
+    return result;
+  }
+
+/**
+ * @brief Writes the '0'/'1' form of the rope to an output stream in fixed-size chunks.
+ *
+ * @param output The output stream to write to.
+ */
+  void SignalRope::write(std::ostream &output) const {
+    StreamSink sink(output);
+    auto visit = [&sink](bool level, std::int64_t time){ sink.put(level ? '1' : '0', time); };
+    forEach(root, visit);
+    sink.flush();
+  }
+
+}
@@ -14,7 +14,7 @@ namespace lab2{
  * @param time The time during which the signal level remains constant.
  * @throw std::invalid_argument if invalid values are provided.
  */
-  SignalState::SignalState(int level, int time){
+  SignalState::SignalState(int level, std::int64_t time){
     if (!(level < 0 || level > 1) && time > 0){
       this->level = level;
       this->time = time;
@@ -52,18 +52,20 @@ namespace lab2{
  * @brief Constructor for the SignalState class based on a vector of integers.
  *
  * This constructor creates a SignalState object based on a vector of integers representing a signal.
+ * Only the first run of the vector is taken, every non-zero value is a high level.
+ * Use BinarySignal::fromSamples() to encode the whole vector.
  *
  * @param signal The vector of integers representing the signal (0 and 1).
  * @throw std::invalid_argument if the vector is empty or contains invalid values.
  */
-  SignalState::SignalState(std::vector<int> &signal) {
+  SignalState::SignalState(const std::vector<int> &signal) {
     if (signal.empty()) {
       throw std::invalid_argument("error: empty signal vector");
     }
     int count = 0;
     this->level = (signal[0] != 0);
     for (int i = 0; i < (int)signal.size(); i++){
-      if (signal[i] != this->level){
+      if ((signal[i] != 0) != this->level){
         break;
       }
       count++;
@@ -112,7 +114,7 @@ namespace lab2{
  *
  * @return The time at which the signal level remains constant.
  */
-  int SignalState::getTime() const{
+  std::int64_t SignalState::getTime() const{
     return time;
   }
 
@@ -132,7 +134,7 @@ namespace lab2{
  * @param time The signal time.
  * @throw std::invalid_argument if the time is less than or equal to 0.
  */
-  void SignalState::setTime(int time){
+  void SignalState::setTime(std::int64_t time){
     if (time >= 0){
       this->time = time;
     }
@@ -171,10 +173,11 @@ namespace lab2{
  *
  * @param duration The duration to add to the signal.
  * @throw std::invalid_argument if an invalid duration is provided (non-positive).
+ * @throw std::overflow_error if the resulting duration does not fit the time type.
  */
-  void SignalState::elongateSignal(int duration){
+  void SignalState::elongateSignal(std::int64_t duration){
     if (duration > 0){
-      time += duration;
+      time = checkedAdd(time, duration);
     }
     else{
       throw std::invalid_argument("error: invalid time value");
@@ -189,7 +192,7 @@ namespace lab2{
  * @param duration The duration to remove from the signal.
  * @throw std::invalid_argument if an invalid duration is provided (non-positive or greater than the current time).
  */
-  void SignalState::truncateSignal(int duration){
+  void SignalState::truncateSignal(std::int64_t duration){
     if (duration > 0 && duration <= time){
       time -= duration;
     }
@@ -208,12 +211,7 @@ namespace lab2{
  */
   std::string SignalState::formatSignal() const{
     if (time == 0){ return "x"; }
-    std::string chart;
-    char symbol = (level ? '\'' : '.'); 
-    for (int i = 0; i < time; i++){
-      chart += symbol;
-    }
-    return chart;
+    return std::string(time, (level ? '\'' : '.'));
   }
 
 /**
@@ -250,7 +248,8 @@ namespace lab2{
  * @return The input stream.
  */
   std::istream &operator >>(std::istream &input, SignalState &signal) {
-    int lvl, time;
+    int lvl;
+    std::int64_t time;
     if (input >> lvl >> time) {
       try {
         signal = SignalState(lvl, time);
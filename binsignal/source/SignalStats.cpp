@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <stdexcept>
+
+#include "SignalStats.h"
+
+namespace lab2{
+
+  namespace {
+
+/**
+ * @brief Collects the widths times[from], ..., times[to - 1] in one sweep.
+ *
+ * Runs at odd and even indices have different levels, so each index parity has its own
+ * sum, minimum, maximum and histogram, all updated in the same pass over the runs.
+ */
+    void sweepWidths(const std::int64_t *times, int from, int to, PulseWidths &even, PulseWidths &odd){
+      PulseWidths *widths[2] = {&even, &odd};
+      std::int64_t sum_time[2] = {0, 0};
+      std::int64_t min_time[2] = {std::numeric_limits<std::int64_t>::max(), std::numeric_limits<std::int64_t>::max()};
+      std::int64_t max_time[2] = {0, 0};
+      for (int i = from; i < to; i++){
+        int parity = i & 1;
+        sum_time[parity] += times[i];
+        min_time[parity] = std::min(min_time[parity], times[i]);
+        max_time[parity] = std::max(max_time[parity], times[i]);
+        widths[parity]->histogram[std::bit_width((std::uint64_t)times[i]) - 1]++;
+      }
+      for (int parity = 0; parity < 2; parity++){
+        int first = from + ((from & 1) != parity);
+        if (first < to){
+          widths[parity]->count = (to - first + 1) / 2;
+          widths[parity]->total = sum_time[parity];
+          widths[parity]->min = min_time[parity];
+          widths[parity]->max = max_time[parity];
+        }
+      }
+    }
+
+  }
+
+/**
+ * @brief Accounts a pulse of the given width.
+ *
+ * The histogram bucket k counts the widths in [2^k, 2^(k+1)).
+ *
+ * @param width The positive width of the pulse.
+ */
+  void PulseWidths::add(std::int64_t width){
+    min = (count == 0) ? width : std::min(min, width);
+    max = std::max(max, width);
+    count++;
+    total += width;
+    histogram[std::bit_width((std::uint64_t)width) - 1]++;
+  }
+
+/**
+ * @brief Accounts the pulses counted by another PulseWidths.
+ *
+ * @param other The partial result to merge.
+ */
+  void PulseWidths::merge(const PulseWidths &other){
+    if (other.count == 0){
+      return;
+    }
+    min = (count == 0) ? other.min : std::min(min, other.min);
+    max = std::max(max, other.max);
+    count += other.count;
+    total += other.total;
+    for (int i = 0; i < PULSE_HISTOGRAM_SIZE; i++){
+      histogram[i] += other.histogram[i];
+    }
+  }
+
+/**
+ * @brief Get the mean width of the pulses.
+ *
+ * @return The mean width, 0 if there are no pulses.
+ */
+  double PulseWidths::mean() const {
+    return (count != 0) ? (double)total / (double)count : 0.0;
+  }
+
+/**
+ * @brief Constructs the statistics of an empty signal.
+ */
+  SignalStats::SignalStats() : runs(0), first_level(false), first_time(0), last_level(false), last_time(0), high_time(0), low_time(0) {}
+
+/**
+ * @brief Computes the statistics of a signal in a single pass over its runs.
+ *
+ * Both levels are reduced in the same sweep, the widths of even and odd runs are kept apart.
+ * A pulse is a run between two edges, so the first and the last run are not counted
+ * as pulses: they may be cut by the bounds of the capture or of the slice. They are kept
+ * separately and become pulses when statistics of neighbouring intervals are merged.
+ *
+ * @param view The signal, a whole BinarySignal, a slice or a mapped file.
+ */
+  SignalStats::SignalStats(const BinarySignalView &view) : SignalStats() {
+    int count = view.getCount();
+    if (count == 0){
+      return;
+    }
+    SignalState first = view.getState(0);
+    SignalState last = view.getState(count - 1);
+    this->runs = count;
+    this->first_level = first.getLevel();
+    this->first_time = first.getTime();
+    this->last_level = last.getLevel();
+    this->last_time = last.getTime();
+    PulseWidths odd, even;
+    sweepWidths(view.times, 1, count - 1, even, odd);
+    std::int64_t even_time = first.getTime() + even.total, odd_time = odd.total;
+    if (count > 1){
+      (((count - 1) % 2 == 0) ? even_time : odd_time) += last.getTime();
+    }
+    (first_level ? high : low).merge(even);
+    (first_level ? low : high).merge(odd);
+    this->high_time = first_level ? even_time : odd_time;
+    this->low_time = first_level ? odd_time : even_time;
+  }
+
+  void SignalStats::addPulse(bool level, std::int64_t width){
+    (level ? high : low).add(width);
+  }
+
+/**
+ * @brief Computes the statistics of windows sliding over a signal.
+ *
+ * The runs covering the start and the end of the windows are tracked by two cursors that only
+ * move forward, so finding the windows takes O(runs + windows) with or without the time index,
+ * and then every window is reduced over the runs inside it. The last window may be shorter than window.
+ *
+ * @param view The signal.
+ * @param window The duration of a window.
+ * @param step The distance between the starts of neighbouring windows.
+ * @return The statistics of every window in order of time.
+ * @throw std::invalid_argument if window or step is not positive.
+ */
+  std::vector<SignalStats> SignalStats::windows(const BinarySignalView &view, std::int64_t window, std::int64_t step){
+    if (window <= 0 || step <= 0){
+      throw std::invalid_argument("error: not positive number");
+    }
+    std::vector<SignalStats> result;
+    int first = 0, last = 0;
+    std::int64_t first_start = 0, last_start = 0;
+    for (std::int64_t time = 0; time < view.totalTime(); time += step){
+      std::int64_t duration = std::min(window, view.totalTime() - time);
+      while (first_start + view.runTime(first) <= time){
+        first_start += view.runTime(first);
+        first++;
+      }
+      if (last < first){
+        last = first;
+        last_start = first_start;
+      }
+      while (last_start + view.runTime(last) < time + duration){
+        last_start += view.runTime(last);
+        last++;
+      }
+      result.emplace_back(view.cut(first, first_start, last, last_start, time, duration));
+      if (view.totalTime() - time <= step){
+        break;
+      }
+    }
+    return result;
+  }
+
+/**
+ * @brief Get the number of runs in the interval.
+ *
+ * @return The number of runs.
+ */
+  std::int64_t SignalStats::getRunCount() const {
+    return runs;
+  }
+
+/**
+ * @brief Get the time the signal spends at the high level.
+ *
+ * @return The high time.
+ */
+  std::int64_t SignalStats::getHighTime() const {
+    return high_time;
+  }
+
+/**
+ * @brief Get the time the signal spends at the low level.
+ *
+ * @return The low time.
+ */
+  std::int64_t SignalStats::getLowTime() const {
+    return low_time;
+  }
+
+/**
+ * @brief Get the duration of the interval.
+ *
+ * @return The total time.
+ */
+  std::int64_t SignalStats::totalTime() const {
+    return high_time + low_time;
+  }
+
+/**
+ * @brief Get the share of the time the signal spends at the high level.
+ *
+ * @return The duty cycle in [0, 1], 0 for an empty signal.
+ */
+  double SignalStats::dutyCycle() const {
+    return (totalTime() != 0) ? (double)high_time / (double)totalTime() : 0.0;
+  }
+
+/**
+ * @brief Get the widths of the complete pulses of the given level.
+ *
+ * @param level true for high pulses, false for low pulses.
+ * @return The pulse widths.
+ */
+  const PulseWidths &SignalStats::pulses(bool level) const {
+    return level ? high : low;
+  }
+
+/**
+ * @brief Merges the statistics of the interval directly following this one.
+ *
+ * The last run of this interval and the first run of the other one are joined if their
+ * levels are equal, and become pulses once they are inside the merged interval. The result
+ * equals the statistics of the whole interval, so a signal can be reduced in independent chunks.
+ *
+ * @param other The statistics of the following interval.
+ * @return A reference to the merged statistics.
+ */
+  SignalStats &SignalStats::operator +=(const SignalStats &other){
+    if (other.runs == 0){
+      return *this;
+    }
+    if (runs == 0){
+      *this = other;
+      return *this;
+    }
+    high_time += other.high_time;
+    low_time += other.low_time;
+    high.merge(other.high);
+    low.merge(other.low);
+    if (last_level == other.first_level){
+      std::int64_t joined = last_time + other.first_time;
+      if (runs > 1 && other.runs > 1){
+        addPulse(last_level, joined);
+      }
+      if (runs == 1){
+        first_time = joined;
+      }
+      last_time = (other.runs == 1) ? joined : other.last_time;
+      runs += other.runs - 1;
+    }
+    else{
+      if (runs > 1){
+        addPulse(last_level, last_time);
+      }
+      if (other.runs > 1){
+        addPulse(other.first_level, other.first_time);
+      }
+      last_time = other.last_time;
+      runs += other.runs;
+    }
+    last_level = other.last_level;
+    return *this;
+  }
+
+}
@@ -1,10 +1,22 @@
 
 #define CATCH_CONFIG_MAIN // Просит Catch2 реализовать свой main, снимая эту задачу с разработчика
 
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <sstream>
+#include <thread>
 #include <catch2/catch.hpp>
 #include "SignalState.h"
 #include "BinarySignal.h"
+#include "BinarySignalBuilder.h"
+#include "ConcurrentSignal.h"
+#include "RepeatedSignal.h"
+#include "Parallel.h"
+#include "SampleScan.h"
+#include "SignalRope.h"
+#include "SignalStats.h"
 
 TEST_CASE("SignalState Constructors") {
     SECTION("Default Constructor") {
@@ -297,3 +309,1108 @@ TEST_CASE("BinarySignal output operator <<") {
         REQUIRE(output.str() == "00011010");
     }
 }
+
+TEST_CASE("BinarySignal capacity") {
+    SECTION("Appends grow geometrically") {
+        lab2::BinarySignal signal;
+        for (int i = 0; i < 100; i++) {
+            signal += lab2::SignalState(i % 2, 1);
+        }
+        REQUIRE(signal.getCount() == 100);
+        REQUIRE(signal.getCapacity() >= 100);
+        REQUIRE(signal.getCapacity() < 200 + 4);
+    }
+
+    SECTION("Reserve and shrinkToFit") {
+        lab2::BinarySignal signal("0011");
+        signal.reserve(64);
+        REQUIRE(signal.getCapacity() == 64);
+        REQUIRE(signal.toString() == "0011");
+        signal.shrinkToFit();
+        REQUIRE(signal.getCapacity() == signal.getCount());
+        REQUIRE(signal.toString() == "0011");
+        REQUIRE_THROWS_AS(signal.reserve(-1), std::invalid_argument);
+    }
+
+    SECTION("Capacity survives copy and move") {
+        lab2::BinarySignal signal("01");
+        signal.reserve(32);
+        lab2::BinarySignal copy(signal);
+        REQUIRE(copy.getCapacity() == 32);
+        lab2::BinarySignal moved(std::move(copy));
+        REQUIRE(moved.getCapacity() == 32);
+        REQUIRE(moved.toString() == "01");
+    }
+
+    SECTION("Appending to an empty signal") {
+        lab2::BinarySignal signal;
+        signal += lab2::BinarySignal("01");
+        REQUIRE(signal.toString() == "01");
+        signal += signal;
+        REQUIRE(signal.toString() == "0101");
+    }
+}
+
+TEST_CASE("BinarySignal time index") {
+    lab2::BinarySignal signal("0011101");
+    REQUIRE_FALSE(signal.hasTimeIndex());
+    REQUIRE(signal.runIndexAt(3) == 1);
+    signal.buildTimeIndex();
+    REQUIRE(signal.hasTimeIndex());
+    REQUIRE(signal.totalTime() == 7);
+    REQUIRE(signal.runIndexAt(0) == 0);
+    REQUIRE(signal.runIndexAt(2) == 1);
+    REQUIRE(signal.runIndexAt(5) == 2);
+    REQUIRE(signal.runIndexAt(6) == 3);
+    REQUIRE_THROWS_AS(signal.runIndexAt(7), std::invalid_argument);
+    REQUIRE(signal[4] == true);
+
+    SECTION("Index follows edits") {
+        signal += lab2::SignalState(0, 3);
+        REQUIRE(signal.totalTime() == 10);
+        signal.insertSignal(lab2::BinarySignal("11"), 1);
+        REQUIRE(signal.toString() == "011011101000");
+        REQUIRE(signal.totalTime() == 12);
+        signal.removeSignal(2, 5);
+        REQUIRE(signal.toString() == "0101000");
+        REQUIRE(signal.hasTimeIndex());
+        REQUIRE(signal.totalTime() == 7);
+        REQUIRE(signal[6] == false);
+        signal *= 2;
+        REQUIRE(signal.totalTime() == 14);
+    }
+
+    SECTION("Index survives copy") {
+        lab2::BinarySignal copy;
+        copy = signal;
+        REQUIRE(copy.hasTimeIndex());
+        copy.dropTimeIndex();
+        REQUIRE(copy.totalTime() == 7);
+    }
+}
+
+TEST_CASE("BinarySignal canonical form") {
+    SECTION("Multiplication merges seams") {
+        lab2::BinarySignal signal("010");
+        signal *= 3;
+        REQUIRE(signal.toString() == "010010010");
+        REQUIRE(signal.getCount() == 7);
+        REQUIRE(signal.isCanonical());
+        lab2::BinarySignal single("11");
+        single *= 4;
+        REQUIRE(single.getCount() == 1);
+        REQUIRE(single.totalTime() == 8);
+    }
+
+    SECTION("Appending merges equal levels") {
+        lab2::BinarySignal signal("0110");
+        signal += lab2::BinarySignal("001");
+        REQUIRE(signal.getCount() == 4);
+        signal += lab2::SignalState(1, 2);
+        signal += lab2::SignalState();
+        REQUIRE(signal.getCount() == 4);
+        REQUIRE(signal.toString() == "011000111");
+        REQUIRE(signal.isCanonical());
+    }
+
+    SECTION("Insert and remove merge the seams") {
+        lab2::BinarySignal signal("0011");
+        signal.insertSignal(lab2::BinarySignal("01"), 1);
+        REQUIRE(signal.toString() == "001011");
+        REQUIRE(signal.getCount() == 4);
+        signal.removeSignal(2, 1);
+        REQUIRE(signal.toString() == "00011");
+        REQUIRE(signal.getCount() == 2);
+        REQUIRE(signal.isCanonical());
+    }
+
+    SECTION("Normalize keeps a canonical signal") {
+        lab2::BinarySignal signal("1001");
+        signal.normalize();
+        REQUIRE(signal.toString() == "1001");
+        REQUIRE(signal.getCount() == 3);
+    }
+}
+
+TEST_CASE("BinarySignal string parser") {
+    SECTION("Long input") {
+        std::string str;
+        for (int i = 0; i < 50; i++) {
+            str += std::string(i % 13 + 1, (i % 2) ? '1' : '0');
+        }
+        lab2::BinarySignal signal(str);
+        REQUIRE(signal.getCount() == 50);
+        REQUIRE(signal.getCapacity() == 50);
+        REQUIRE(signal.toString() == str);
+    }
+
+    SECTION("Invalid character inside a word") {
+        std::string str(40, '0');
+        str[21] = '2';
+        REQUIRE_THROWS_AS(lab2::BinarySignal(str), std::invalid_argument);
+        str[21] = '0';
+        str[39] = 'a';
+        REQUIRE_THROWS_AS(lab2::BinarySignal(str), std::invalid_argument);
+    }
+
+    SECTION("Empty and string_view input") {
+        REQUIRE(lab2::BinarySignal("").getCount() == 0);
+        std::string_view view("xx0110xx");
+        lab2::BinarySignal signal(view.substr(2, 4));
+        REQUIRE(signal.toString() == "0110");
+    }
+}
+
+TEST_CASE("BinarySignal fromSamples") {
+    std::string kernel = lab2::sampleScanKernel();
+    for (const char *name : {"scalar", "sse2", "avx2"}) {
+        if (!lab2::setSampleScanKernel(name)) {
+            continue;
+        }
+        for (int length : {0, 1, 7, 16, 33, 100, 257}) {
+            std::vector<std::uint8_t> bytes(length);
+            std::vector<int> ints(length);
+            std::vector<std::uint64_t> bits((length + 63) / 64);
+            std::string expected;
+            unsigned seed = 12345;
+            for (int i = 0; i < length; i++) {
+                seed = seed * 1103515245 + 12345;
+                bool previous = i != 0 && expected.back() == '1';
+                bool level = ((seed >> 16) % 5 < 2) ? !previous : previous;
+                bytes[i] = level ? (std::uint8_t)(seed >> 8 | 1) : 0;
+                ints[i] = level ? -(int)(seed % 1000 + 1) : 0;
+                bits[i / 64] |= std::uint64_t(level) << (i % 64);
+                expected += level ? '1' : '0';
+            }
+            lab2::BinarySignal from_bytes = lab2::BinarySignal::fromSamples(std::span<const std::uint8_t>(bytes));
+            lab2::BinarySignal from_ints = lab2::BinarySignal::fromSamples(std::span<const int>(ints));
+            lab2::BinarySignal from_bits = lab2::BinarySignal::fromSamples(bits, length);
+            REQUIRE(from_bytes.toString() == expected);
+            REQUIRE(from_ints.toString() == expected);
+            REQUIRE(from_bits.toString() == expected);
+            REQUIRE(from_bytes.getCapacity() == from_bytes.getCount());
+            REQUIRE(from_bytes.isCanonical());
+        }
+    }
+    lab2::setSampleScanKernel(kernel.c_str());
+    REQUIRE(kernel == lab2::sampleScanKernel());
+    std::vector<std::uint64_t> bits(1);
+    REQUIRE_THROWS_AS(lab2::BinarySignal::fromSamples(bits, 65), std::invalid_argument);
+}
+
+TEST_CASE("BinarySignal toBits") {
+    lab2::BinarySignal signal("0111");
+    signal += lab2::SignalState(0, 60);
+    signal += lab2::SignalState(1, 130);
+    signal += lab2::SignalState(0, 3);
+    std::vector<std::uint64_t> bits = signal.toBits();
+    REQUIRE(bits.size() == 4);
+    REQUIRE(bits[0] == 0xEull);
+    REQUIRE(bits[1] == ~0ull);
+    REQUIRE(bits[2] == ~0ull);
+    REQUIRE(bits[3] == 0x3ull);
+    REQUIRE(lab2::BinarySignal::fromSamples(bits, signal.totalTime()).toString() == signal.toString());
+
+    std::vector<std::uint64_t> small(3);
+    REQUIRE_THROWS_AS(signal.toBits(small), std::invalid_argument);
+    REQUIRE(lab2::BinarySignal().toBits().empty());
+}
+
+TEST_CASE("BinarySignal streaming renderers") {
+    lab2::BinarySignal signal("0110");
+    signal += lab2::SignalState(1, 5000);
+    signal += lab2::SignalState(0, 3);
+    std::ostringstream plain;
+    signal.write(plain);
+    REQUIRE(plain.str() == signal.toString());
+    REQUIRE(plain.str().length() == 5007);
+    std::ostringstream chart;
+    signal.writeFormated(chart);
+    REQUIRE(chart.str() == signal.formatedSignal());
+    REQUIRE(chart.str().substr(0, 7) == "./''\\./");
+    REQUIRE(chart.str().length() == 5007 + 4);
+    REQUIRE(lab2::BinarySignal().formatedSignal().empty());
+}
+
+TEST_CASE("BinarySignal binary format") {
+    lab2::BinarySignal signal("1100010");
+    signal += lab2::SignalState(0, 300);
+
+    SECTION("Round trip in both encodings") {
+        for (int encoding : {FIXED_ENCODING, VARINT_ENCODING}) {
+            std::stringstream stream;
+            signal.save(stream, encoding);
+            lab2::BinarySignal loaded = lab2::BinarySignal::load(stream);
+            REQUIRE(loaded.toString() == signal.toString());
+            REQUIRE(loaded.getCapacity() == loaded.getCount());
+        }
+        std::stringstream stream;
+        lab2::BinarySignal().save(stream, VARINT_ENCODING);
+        REQUIRE(lab2::BinarySignal::load(stream).getCount() == 0);
+    }
+
+    SECTION("Signals back to back") {
+        std::stringstream stream;
+        signal.save(stream, VARINT_ENCODING);
+        (~signal).save(stream, FIXED_ENCODING, true);
+        stream << "tail";
+        REQUIRE(lab2::BinarySignal::load(stream).toString() == signal.toString());
+        REQUIRE(lab2::BinarySignal::load(stream).toString() == (~signal).toString());
+        std::string rest;
+        stream >> rest;
+        REQUIRE(rest == "tail");
+    }
+
+    SECTION("Invalid data") {
+        std::stringstream stream;
+        REQUIRE_THROWS_AS(signal.save(stream, VARINT_ENCODING, true), std::invalid_argument);
+        std::stringstream garbage("not a signal file at all");
+        REQUIRE_THROWS_AS(lab2::BinarySignal::load(garbage), std::invalid_argument);
+        signal.save(stream);
+        std::stringstream truncated(stream.str().substr(0, 30));
+        REQUIRE_THROWS_AS(lab2::BinarySignal::load(truncated), std::runtime_error);
+        std::string header = stream.str().substr(0, SIGNAL_HEADER_SIZE);
+        for (int i = 0; i < 4; i++){
+            header[8 + i] = '\xff';
+        }
+        header[11] = '\x7f';
+        std::stringstream huge(header + std::string(16, '\x01'));
+        REQUIRE_THROWS_AS(lab2::BinarySignal::load(huge), std::runtime_error);
+    }
+
+    SECTION("View over saved data") {
+        std::stringstream stream;
+        signal.save(stream, FIXED_ENCODING, true);
+        std::string data = stream.str();
+        std::vector<std::int64_t> aligned((data.size() + 7) / 8);
+        std::memcpy(aligned.data(), data.data(), data.size());
+        lab2::BinarySignalView view(aligned.data(), data.size());
+        REQUIRE(view.hasTimeIndex());
+        REQUIRE(view.getCount() == signal.getCount());
+        REQUIRE(view.totalTime() == signal.totalTime());
+        REQUIRE(view.toString() == signal.toString());
+        REQUIRE(view[5] == true);
+        REQUIRE(view[300] == false);
+        REQUIRE(view.runIndexAt(5) == 2);
+        REQUIRE(view.getState(0).getLevel() == true);
+        REQUIRE(view.getState(3).getTime() == 301);
+        REQUIRE_THROWS_AS(view.getState(4), std::invalid_argument);
+        REQUIRE(lab2::BinarySignal(view).toString() == signal.toString());
+        REQUIRE_THROWS_AS(lab2::BinarySignalView(aligned.data(), 30), std::invalid_argument);
+
+        std::vector<std::int64_t> corrupt = aligned;
+        corrupt[SIGNAL_HEADER_SIZE / 8 + 1] += 1000;
+        REQUIRE_THROWS_AS(lab2::BinarySignalView(corrupt.data(), data.size()), std::invalid_argument);
+        REQUIRE(lab2::BinarySignalView(corrupt.data(), data.size(), false).totalTime() == signal.totalTime());
+        corrupt = aligned;
+        corrupt[SIGNAL_HEADER_SIZE / 8 + signal.getCount() + 1] = 0;
+        REQUIRE_THROWS_AS(lab2::BinarySignalView(corrupt.data(), data.size()), std::invalid_argument);
+        corrupt = aligned;
+        corrupt[2] += 1;
+        REQUIRE_THROWS_AS(lab2::BinarySignalView(corrupt.data(), data.size()), std::invalid_argument);
+    }
+
+    SECTION("Mapped file") {
+        std::filesystem::path path = std::filesystem::temp_directory_path() / "binsignal_test.bsig";
+        {
+            std::ofstream file(path, std::ios::binary);
+            signal.save(file);
+        }
+        {
+            lab2::SignalFile file(path.string());
+            lab2::BinarySignalView view = file.view();
+            REQUIRE_FALSE(view.hasTimeIndex());
+            REQUIRE(view[2] == false);
+            std::ostringstream output;
+            view.write(output);
+            REQUIRE(output.str() == signal.toString());
+        }
+        std::filesystem::remove(path);
+        REQUIRE_THROWS_AS(lab2::SignalFile(path.string()), std::runtime_error);
+    }
+}
+
+TEST_CASE("BinarySignal getState") {
+    lab2::BinarySignal signal("1110010");
+    REQUIRE(signal.getState(0).getLevel() == true);
+    REQUIRE(signal.getState(0).getTime() == 3);
+    REQUIRE(signal.getState(1).getLevel() == false);
+    REQUIRE(signal.getState(1).getTime() == 2);
+    REQUIRE(signal.getState(3).getLevel() == false);
+    REQUIRE_THROWS_AS(signal.getState(4), std::invalid_argument);
+    signal.invertSignal();
+    REQUIRE(signal.getState(2).getLevel() == false);
+    REQUIRE(signal.toString() == "0001101");
+    lab2::BinarySignal empty;
+    empty += lab2::SignalState(1, 2);
+    REQUIRE(empty.getState(0).getLevel() == true);
+}
+
+TEST_CASE("BinarySignal 64-bit time") {
+    const std::int64_t long_time = 3000000000LL;
+    lab2::BinarySignal signal(1, long_time);
+    signal += lab2::SignalState(0, long_time);
+    REQUIRE(signal.totalTime() == 2 * long_time);
+    REQUIRE(signal[long_time - 1] == true);
+    REQUIRE(signal[long_time] == false);
+    REQUIRE(signal.getState(1).getTime() == long_time);
+    signal *= 3;
+    REQUIRE(signal.getCount() == 6);
+    REQUIRE(signal.totalTime() == 6 * long_time);
+    signal.removeSignal(long_time, 4 * long_time);
+    REQUIRE(signal.getCount() == 2);
+    REQUIRE(signal.totalTime() == 2 * long_time);
+
+    std::stringstream data;
+    signal.save(data, VARINT_ENCODING);
+    REQUIRE(lab2::BinarySignal::load(data).getState(0).getTime() == long_time);
+
+    lab2::BinarySignal huge(1, std::numeric_limits<std::int64_t>::max() / 2 + 1);
+    REQUIRE_THROWS_AS(huge *= 3, std::overflow_error);
+    REQUIRE(huge.totalTime() == std::numeric_limits<std::int64_t>::max() / 2 + 1);
+    REQUIRE_THROWS_AS(huge += huge, std::overflow_error);
+    REQUIRE_THROWS_AS(lab2::SignalState(1, std::numeric_limits<std::int64_t>::max()).elongateSignal(1), std::overflow_error);
+}
+
+TEST_CASE("BinarySignal bitwise operators") {
+    lab2::BinarySignal a("1100110011");
+    lab2::BinarySignal b("1111000001");
+    SECTION("Operators") {
+        REQUIRE((a & b).toString() == "1100000001");
+        REQUIRE((a | b).toString() == "1111110011");
+        REQUIRE((a ^ b).toString() == "0011110010");
+        REQUIRE((a ^ a).getCount() == 1);
+        REQUIRE((a ^ a).toString() == "0000000000");
+        REQUIRE((a & b).isCanonical());
+        REQUIRE((a | b).getCount() == 3);
+    }
+
+    SECTION("Compound forms") {
+        a.buildTimeIndex();
+        a &= b;
+        REQUIRE(a.toString() == "1100000001");
+        REQUIRE(a.hasTimeIndex());
+        REQUIRE(a[9] == true);
+        a |= ~b;
+        REQUIRE(a.toString() == "1100111111");
+        a ^= a;
+        REQUIRE(a.toString() == "0000000000");
+    }
+
+    SECTION("Different durations") {
+        REQUIRE_THROWS_AS(a & lab2::BinarySignal("101"), std::invalid_argument);
+        REQUIRE_THROWS_AS(b |= lab2::BinarySignal(), std::invalid_argument);
+        REQUIRE((lab2::BinarySignal() ^ lab2::BinarySignal()).getCount() == 0);
+    }
+}
+
+TEST_CASE("RepeatedSignal") {
+    SECTION("Merged seams") {
+        lab2::BinarySignal pattern("1100111");
+        lab2::RepeatedSignal repeated = pattern.repeat(3);
+        lab2::BinarySignal expanded = pattern * 3;
+        REQUIRE(repeated.totalTime() == 21);
+        REQUIRE(repeated.getCount() == expanded.getCount());
+        REQUIRE(repeated.toString() == expanded.toString());
+        REQUIRE(repeated.materialize().toString() == expanded.toString());
+        for (int i = 0; i < expanded.getCount(); i++){
+            REQUIRE(repeated.getState(i).getLevel() == expanded.getState(i).getLevel());
+            REQUIRE(repeated.getState(i).getTime() == expanded.getState(i).getTime());
+        }
+        for (int t = 0; t < 21; t++){
+            REQUIRE(repeated[t] == expanded[t]);
+            REQUIRE(repeated.runIndexAt(t) == expanded.runIndexAt(t));
+        }
+        REQUIRE_THROWS_AS(repeated[21], std::invalid_argument);
+        REQUIRE_THROWS_AS(repeated.getState(repeated.getCount()), std::invalid_argument);
+    }
+
+    SECTION("Iteration without expanding") {
+        static_assert(std::random_access_iterator<lab2::RepeatedRunIterator>);
+        static_assert(std::forward_iterator<lab2::RepeatedSampleIterator>);
+        static_assert(std::ranges::forward_range<lab2::RepeatedEdgeRange>);
+        for (const char *text : {"1100111", "1000", "1", "0110"}){
+            lab2::BinarySignal pattern(text);
+            lab2::RepeatedSignal repeated = pattern.repeat(5);
+            lab2::BinarySignal expanded = pattern * 5;
+            REQUIRE(repeated.end() - repeated.begin() == expanded.getCount());
+            REQUIRE(std::ranges::equal(repeated, expanded, [](lab2::SignalState a, lab2::SignalState b){
+                return a.getLevel() == b.getLevel() && a.getTime() == b.getTime();
+            }));
+            REQUIRE(repeated.begin()[expanded.getCount() - 1].getTime() == expanded.getState(expanded.getCount() - 1).getTime());
+            REQUIRE(std::ranges::equal(repeated.samples(), expanded.samples()));
+            for (int kind : {EDGE_ANY, EDGE_RISING, EDGE_FALLING}){
+                REQUIRE(std::ranges::equal(repeated.edges(kind), expanded.view().edges(kind)));
+            }
+        }
+        REQUIRE_THROWS_AS(lab2::BinarySignal("10").repeat(2).edges(5), std::invalid_argument);
+    }
+
+    SECTION("Even and single run patterns") {
+        lab2::BinarySignal pattern("1000");
+        REQUIRE(pattern.repeat(4).getCount() == 8);
+        REQUIRE(pattern.repeat(4).runIndexAt(13) == 7);
+        std::ostringstream output;
+        pattern.repeat(2).write(output);
+        REQUIRE(output.str() == "10001000");
+        lab2::RepeatedSignal single = lab2::BinarySignal(1, 5).repeat(3);
+        REQUIRE(single.getCount() == 1);
+        REQUIRE(single.getState(0).getTime() == 15);
+    }
+
+    SECTION("Huge repeat count") {
+        lab2::RepeatedSignal repeated = lab2::BinarySignal("10").repeat(1000000000000LL);
+        REQUIRE(repeated.totalTime() == 2000000000000LL);
+        REQUIRE(repeated[1999999999998LL] == true);
+        REQUIRE(repeated[1999999999999LL] == false);
+        REQUIRE(repeated.getState(1999999999999LL).getLevel() == false);
+        REQUIRE(*std::ranges::next(repeated.edges(EDGE_RISING).begin(), 3) == lab2::Edge{8, true});
+        REQUIRE((*(repeated.end() - 1)).getLevel() == false);
+        REQUIRE_THROWS_AS(repeated.materialize(), std::invalid_argument);
+        REQUIRE_THROWS_AS(lab2::BinarySignal("10").repeat(0), std::invalid_argument);
+        REQUIRE_THROWS_AS(lab2::BinarySignal("10").repeat(std::numeric_limits<std::int64_t>::max()), std::overflow_error);
+    }
+}
+
+TEST_CASE("SignalRope") {
+    SECTION("Construction and lookup") {
+        lab2::BinarySignal signal("1100111010");
+        lab2::SignalRope rope(signal);
+        REQUIRE(rope.getCount() == signal.getCount());
+        REQUIRE(rope.totalTime() == 10);
+        REQUIRE(rope.toString() == signal.toString());
+        REQUIRE(rope.toSignal().toString() == signal.toString());
+        for (int t = 0; t < 10; t++){
+            REQUIRE(rope[t] == signal[t]);
+            REQUIRE(rope.runIndexAt(t) == signal.runIndexAt(t));
+        }
+        REQUIRE(rope.getState(2).getTime() == 3);
+        REQUIRE_THROWS_AS(rope[10], std::invalid_argument);
+        REQUIRE_THROWS_AS(rope.getState(6), std::invalid_argument);
+        REQUIRE(lab2::SignalRope().getCount() == 0);
+    }
+
+    SECTION("Edits match BinarySignal") {
+        lab2::BinarySignal signal("110100");
+        lab2::SignalRope rope(signal);
+        lab2::BinarySignal piece("0110");
+        lab2::SignalRope rope_piece(piece);
+        unsigned state = 1;
+        for (int i = 0; i < 200; i++){
+            state = state * 1103515245u + 12345u;
+            std::int64_t time = (state >> 8) % (signal.totalTime() + 1);
+            if (i % 3 != 2){
+                signal.insertSignal(piece, time);
+                rope.insertSignal(rope_piece, time);
+            }
+            else{
+                std::int64_t duration = (state >> 16) % (signal.totalTime() - time + 1);
+                signal.removeSignal(time, duration);
+                rope.removeSignal(time, duration);
+            }
+            REQUIRE(rope.getCount() == signal.getCount());
+            REQUIRE(rope.totalTime() == signal.totalTime());
+        }
+        REQUIRE(rope.toString() == signal.toString());
+        std::ostringstream output;
+        rope.write(output);
+        REQUIRE(output.str() == signal.toString());
+    }
+
+    SECTION("Edits across chunks") {
+        std::string pattern;
+        for (int i = 0; i < 3000; i++){
+            pattern += std::string(i % 5 + 1, (i % 2 == 0) ? '1' : '0');
+        }
+        lab2::BinarySignal signal(pattern);
+        lab2::SignalRope rope(signal);
+        REQUIRE(rope.getCount() == 3000);
+        REQUIRE(rope.toString() == pattern);
+        lab2::BinarySignal piece("10011");
+        lab2::SignalRope rope_piece(piece);
+        unsigned state = 7;
+        for (int i = 0; i < 300; i++){
+            state = state * 1103515245u + 12345u;
+            std::int64_t time = (state >> 8) % (signal.totalTime() + 1);
+            if (i % 2 == 0){
+                signal.insertSignal(piece, time);
+                rope.insertSignal(rope_piece, time);
+            }
+            else{
+                std::int64_t duration = (state >> 16) % 20 % (signal.totalTime() - time + 1);
+                signal.removeSignal(time, duration);
+                rope.removeSignal(time, duration);
+            }
+        }
+        REQUIRE(rope.getCount() == signal.getCount());
+        REQUIRE(rope.toString() == signal.toString());
+        for (int i = 0; i < signal.getCount(); i += 97){
+            REQUIRE(rope.getState(i).getTime() == signal.getState(i).getTime());
+            REQUIRE(rope.getState(i).getLevel() == signal.getState(i).getLevel());
+        }
+        for (std::int64_t t = 0; t < signal.totalTime(); t += 101){
+            REQUIRE(rope.runIndexAt(t) == signal.runIndexAt(t));
+        }
+        REQUIRE(rope.slice(1000, 3000).toString() == signal.toString().substr(1000, 3000));
+    }
+
+    SECTION("Copies share nodes") {
+        lab2::SignalRope rope(lab2::BinarySignal("1100"));
+        lab2::SignalRope copy = rope;
+        copy.insertSignal(copy, 2);
+        REQUIRE(copy.toString() == "11110000");
+        REQUIRE(copy.getCount() == 2);
+        REQUIRE(rope.toString() == "1100");
+        copy += rope;
+        REQUIRE(copy.toString() == "111100001100");
+        REQUIRE(copy.slice(3, 6).toString() == "100001");
+        copy.removeSignal(2, 8);
+        REQUIRE(copy.toString() == "1100");
+        REQUIRE(copy.getCount() == 2);
+        REQUIRE_THROWS_AS(copy.removeSignal(3, 2), std::invalid_argument);
+        REQUIRE_THROWS_AS(copy.insertSignal(rope, 5), std::invalid_argument);
+    }
+}
+
+TEST_CASE("BinarySignal copy-on-write") {
+    lab2::BinarySignal signal("1100101");
+    signal.buildTimeIndex();
+    SECTION("Copies share until mutated") {
+        lab2::BinarySignal copy = signal;
+        REQUIRE(copy.isShared());
+        REQUIRE(signal.isShared());
+        REQUIRE(copy.hasTimeIndex());
+        copy += lab2::SignalState(0, 2);
+        REQUIRE_FALSE(copy.isShared());
+        REQUIRE_FALSE(signal.isShared());
+        REQUIRE(copy.toString() == "110010100");
+        REQUIRE(signal.toString() == "1100101");
+        REQUIRE(signal[6] == true);
+        REQUIRE(copy[8] == false);
+    }
+
+    SECTION("Every mutation detaches") {
+        lab2::BinarySignal copy;
+        copy = signal;
+        copy *= 2;
+        REQUIRE(signal.toString() == "1100101");
+        copy = signal;
+        copy.insertSignal(lab2::BinarySignal("0"), 0);
+        REQUIRE(signal.toString() == "1100101");
+        copy = signal;
+        copy.dropTimeIndex();
+        REQUIRE(signal.hasTimeIndex());
+        REQUIRE(signal[5] == false);
+        copy = signal;
+        copy.reserve(100);
+        REQUIRE(signal.getCapacity() < 100);
+        REQUIRE_FALSE(copy.isShared());
+        lab2::BinarySignal inverted = ~signal;
+        REQUIRE(inverted.isShared());
+        REQUIRE(inverted.toString() == "0011010");
+        copy = signal;
+        copy &= inverted;
+        REQUIRE(copy.toString() == "0000000");
+        REQUIRE(signal.toString() == "1100101");
+    }
+
+    SECTION("Self-assignment and append") {
+        lab2::BinarySignal copy = signal;
+        copy = copy;
+        copy += copy;
+        REQUIRE(copy.toString() == "11001011100101");
+        REQUIRE(signal.toString() == "1100101");
+        lab2::BinarySignal moved = std::move(copy);
+        REQUIRE_FALSE(moved.isShared());
+        REQUIRE(moved.hasTimeIndex());
+    }
+}
+
+TEST_CASE("BinarySignal inversion") {
+    lab2::BinarySignal signal("1100101");
+    const lab2::BinarySignal &constant = signal;
+    lab2::BinarySignalView inverted = ~constant;
+    REQUIRE_FALSE(signal.isShared());
+    REQUIRE(inverted.toString() == "0011010");
+    REQUIRE(inverted[0] == false);
+    REQUIRE(inverted.getState(1).getLevel() == true);
+    REQUIRE((~inverted).toString() == "1100101");
+    REQUIRE(lab2::BinarySignal(inverted).toString() == "0011010");
+    REQUIRE(constant.view().totalTime() == 7);
+    signal.buildTimeIndex();
+    REQUIRE(signal.view().hasTimeIndex());
+    REQUIRE(signal.view().runIndexAt(6) == 4);
+    lab2::BinarySignal owned = ~signal;
+    owned.invertSignal();
+    REQUIRE(owned.toString() == signal.toString());
+}
+
+TEST_CASE("BinarySignal slice") {
+    lab2::BinarySignal signal("1100011101000111");
+    std::string text = signal.toString();
+    for (int indexed = 0; indexed < 2; indexed++){
+        if (indexed){
+            signal.buildTimeIndex();
+        }
+        for (int time = 0; time <= 16; time++){
+            for (int duration = 0; time + duration <= 16; duration++){
+                lab2::BinarySignalView window = signal.slice(time, duration);
+                REQUIRE(window.totalTime() == duration);
+                REQUIRE(window.toString() == text.substr(time, duration));
+                REQUIRE(lab2::BinarySignal(window).toString() == text.substr(time, duration));
+                for (int t = 0; t < duration; t++){
+                    REQUIRE(window[t] == (text[time + t] == '1'));
+                }
+                if (duration > 2){
+                    REQUIRE(window.slice(1, duration - 2).toString() == text.substr(time + 1, duration - 2));
+                }
+            }
+        }
+    }
+    REQUIRE(signal.slice(2, 3).getCount() == 1);
+    REQUIRE(signal.slice(2, 3).getState(0).getTime() == 3);
+    REQUIRE_THROWS_AS(signal.slice(10, 7), std::invalid_argument);
+    REQUIRE_THROWS_AS(signal.slice(-1, 2), std::invalid_argument);
+    std::ostringstream output;
+    signal.slice(1, 4).write(output);
+    REQUIRE(output.str() == "1000");
+}
+
+static_assert(std::random_access_iterator<lab2::RunIterator>);
+static_assert(std::forward_iterator<lab2::SampleIterator>);
+static_assert(std::ranges::random_access_range<const lab2::BinarySignal>);
+static_assert(std::ranges::sized_range<lab2::BinarySignalView>);
+static_assert(std::ranges::borrowed_range<lab2::BinarySignalView>);
+
+TEST_CASE("BinarySignal iterators") {
+    lab2::BinarySignal signal("1100011101");
+    SECTION("Runs") {
+        REQUIRE(std::ranges::distance(signal) == signal.getCount());
+        auto longest = std::ranges::max_element(signal, {}, &lab2::SignalState::getTime);
+        REQUIRE(longest - signal.begin() == 1);
+        REQUIRE((*longest).getTime() == 3);
+        REQUIRE(signal.begin()[2].getLevel() == true);
+        std::int64_t sum_time = 0;
+        for (lab2::SignalState state : signal){
+            sum_time += state.getTime();
+        }
+        REQUIRE(sum_time == signal.totalTime());
+        auto reversed = signal | std::views::reverse;
+        REQUIRE((*reversed.begin()).getLevel() == true);
+        REQUIRE(std::ranges::count_if(signal, &lab2::SignalState::getLevel) == 3);
+    }
+
+    SECTION("Samples") {
+        std::string text;
+        for (bool sample : signal.samples()){
+            text += sample ? '1' : '0';
+        }
+        REQUIRE(text == signal.toString());
+        REQUIRE(std::ranges::count(signal.samples(), true) == 6);
+        REQUIRE(std::ranges::distance(signal.samples()) == 10);
+        lab2::BinarySignalView window = signal.slice(3, 5);
+        REQUIRE(std::ranges::count(window.samples(), false) == 2);
+        REQUIRE(std::ranges::distance(window) == 2);
+        REQUIRE((*window.begin()).getTime() == 2);
+        REQUIRE(std::ranges::empty(lab2::BinarySignal().samples()));
+    }
+}
+
+static_assert(std::forward_iterator<lab2::EdgeIterator>);
+static_assert(std::ranges::forward_range<lab2::EdgeRange>);
+
+TEST_CASE("BinarySignal edges") {
+    lab2::BinarySignal signal("1100011101");
+    std::vector<lab2::Edge> expected = {{2, false}, {5, true}, {8, false}, {9, true}};
+    std::vector<lab2::Edge> collected;
+    for (lab2::Edge edge : signal.edges()){
+        collected.push_back(edge);
+    }
+    REQUIRE(collected == expected);
+    collected.clear();
+    std::ranges::copy(signal.risingEdges(), std::back_inserter(collected));
+    REQUIRE(collected == std::vector<lab2::Edge>{{5, true}, {9, true}});
+    collected.clear();
+    std::ranges::copy(signal.fallingEdges(), std::back_inserter(collected));
+    REQUIRE(collected == std::vector<lab2::Edge>{{2, false}, {8, false}});
+    REQUIRE(std::ranges::distance((~signal).risingEdges()) == 2);
+    REQUIRE(std::ranges::empty(lab2::BinarySignal(1, 5).edges()));
+    REQUIRE(std::ranges::empty(lab2::BinarySignal("10").risingEdges()));
+
+    std::vector<lab2::Edge> buffer(3);
+    REQUIRE(signal.copyEdges(buffer) == 3);
+    REQUIRE(buffer[2] == lab2::Edge{8, false});
+    REQUIRE(signal.copyEdges(buffer, EDGE_RISING) == 2);
+    REQUIRE(buffer[1] == lab2::Edge{9, true});
+    REQUIRE(signal.slice(3, 6).copyEdges(buffer) == 2);
+    REQUIRE(buffer[0] == lab2::Edge{2, true});
+    REQUIRE(buffer[1] == lab2::Edge{5, false});
+    REQUIRE_THROWS_AS(signal.copyEdges(buffer, 3), std::invalid_argument);
+}
+
+TEST_CASE("BinarySignal batch sampling") {
+    lab2::BinarySignal signal("0011101100");
+    const lab2::BinarySignal &constant = signal;
+    REQUIRE(constant[2] == true);
+
+    std::vector<std::int64_t> sorted = {-1, 0, 2, 2, 5, 6, 9, 10};
+    std::vector<std::uint8_t> out(sorted.size());
+    REQUIRE(constant.sampleAt(sorted, out) == 6);
+    REQUIRE(out == std::vector<std::uint8_t>{SAMPLE_OUT_OF_RANGE, 0, 1, 1, 0, 1, 0, SAMPLE_OUT_OF_RANGE});
+
+    std::vector<std::int64_t> unsorted = {9, 42, 3, 0, 6, -5, 5};
+    std::vector<std::uint8_t> expected = {0, SAMPLE_OUT_OF_RANGE, 1, 0, 1, SAMPLE_OUT_OF_RANGE, 0};
+    out.assign(unsorted.size(), 0);
+    REQUIRE(constant.sampleAtUnsorted(unsorted, out) == 5);
+    REQUIRE(out == expected);
+    signal.buildTimeIndex();
+    out.assign(unsorted.size(), 0);
+    REQUIRE(constant.sampleAtUnsorted(unsorted, out) == 5);
+    REQUIRE(out == expected);
+
+    lab2::BinarySignalView slice = signal.slice(3, 5);
+    std::vector<std::int64_t> slice_times = {4, 0, 2, 5};
+    std::vector<std::uint8_t> slice_out(slice_times.size());
+    REQUIRE(slice.sampleAtUnsorted(slice_times, slice_out) == 3);
+    REQUIRE(slice_out == std::vector<std::uint8_t>{1, 1, 0, SAMPLE_OUT_OF_RANGE});
+
+    std::vector<std::int64_t> descending = {3, 1};
+    REQUIRE_THROWS_AS(signal.sampleAt(descending, std::span<std::uint8_t>(out.data(), 2)), std::invalid_argument);
+    REQUIRE_THROWS_AS(signal.sampleAt(sorted, std::span<std::uint8_t>(out.data(), 1)), std::invalid_argument);
+    out.assign(sorted.size(), 0);
+    REQUIRE(lab2::BinarySignal().sampleAt(sorted, out) == 0);
+    REQUIRE(std::count(out.begin(), out.end(), SAMPLE_OUT_OF_RANGE) == (long)sorted.size());
+}
+
+TEST_CASE("BinarySignal resample") {
+    lab2::BinarySignal signal("0011101100");
+    REQUIRE(signal.resample(1, 2).toString() == "01110");
+    REQUIRE(signal.resample(1, 2, RESAMPLE_ANY).toString() == "01110");
+    REQUIRE(signal.resample(1, 2, RESAMPLE_MAJORITY).toString() == "01010");
+    REQUIRE(signal.resample(3, 1).toString() == "000000111111111000111111000000");
+    REQUIRE(signal.resample(1, 3, RESAMPLE_ANY).toString() == "1110");
+    REQUIRE(signal.resample(1, 3, RESAMPLE_MAJORITY).toString() == "0110");
+    REQUIRE(signal.resample(1, 100, RESAMPLE_ANY).toString() == "1");
+    REQUIRE(signal.resample(1, 100).totalTime() == 0);
+    REQUIRE(signal.resample(7, 7).toString() == signal.toString());
+    REQUIRE(signal.resample(1, 2).isCanonical());
+    REQUIRE_THROWS_AS(signal.resample(0, 1), std::invalid_argument);
+    REQUIRE_THROWS_AS(signal.resample(1, 1, 3), std::invalid_argument);
+    REQUIRE_THROWS_AS(lab2::BinarySignal(1, std::numeric_limits<std::int64_t>::max() / 2).resample(3, 1), std::overflow_error);
+
+    std::string pattern;
+    for (int i = 0; i < 200; i++){
+        pattern += std::string(i * 7 % 5 + 1, (i * 13 % 3 == 0) ? '1' : '0');
+    }
+    lab2::BinarySignal noisy(pattern);
+    const std::int64_t ratios[][2] = {{1, 4}, {2, 3}, {3, 2}, {5, 17}};
+    for (const auto &ratio : ratios){
+        std::int64_t num = ratio[0], den = ratio[1];
+        std::int64_t scaled_total = (std::int64_t)pattern.size() * num;
+        std::string any, majority;
+        for (std::int64_t start = 0; start < scaled_total; start += den){
+            std::int64_t end = std::min(start + den, scaled_total), high = 0;
+            for (std::int64_t t = start / num; t * num < end; t++){
+                if (pattern[t] == '1'){
+                    high += std::min((t + 1) * num, end) - std::max(t * num, start);
+                }
+            }
+            any += (high > 0) ? '1' : '0';
+            majority += (2 * high > end - start) ? '1' : '0';
+        }
+        REQUIRE(noisy.resample(num, den, RESAMPLE_ANY).toString() == any);
+        REQUIRE(noisy.resample(num, den, RESAMPLE_MAJORITY).toString() == majority);
+    }
+}
+
+TEST_CASE("BinarySignal debounce") {
+    lab2::BinarySignal signal("0000010000011111011111");
+    lab2::BinarySignal copy(signal);
+    signal.buildTimeIndex();
+    int capacity = signal.getCapacity();
+    REQUIRE(signal.debounce(2).toString() == "0000000000011111111111");
+    REQUIRE(signal.getCount() == 2);
+    REQUIRE(signal.getCapacity() == capacity);
+    REQUIRE(signal.runIndexAt(11) == 1);
+    REQUIRE(signal.isCanonical());
+    REQUIRE(copy.toString() == "0000010000011111011111");
+    REQUIRE(copy.debounce(1).toString() == "0000010000011111011111");
+
+    lab2::BinarySignal rising("00001100000111");
+    REQUIRE(rising.debounce(3, 1).toString() == "00000000000111");
+    lab2::BinarySignal falling("11110011111000");
+    REQUIRE(falling.debounce(1, 3).toString() == "11111111111000");
+    lab2::BinarySignal glitches("1011010011");
+    REQUIRE(glitches.debounce(2).toString() == "1111110011");
+    REQUIRE(lab2::BinarySignal("1000000").debounce(3).toString() == "0000000");
+    REQUIRE(lab2::BinarySignal("0100111111").debounce(3).toString() == "1111111111");
+    REQUIRE(lab2::BinarySignal("0100011111").debounce(3).toString() == "0000011111");
+    REQUIRE(lab2::BinarySignal("1111110").debounce(3).toString() == "1111111");
+    REQUIRE(lab2::BinarySignal("0001111110").debounce(2).toString() == "0001111111");
+    lab2::BinarySignal noisy("1011");
+    REQUIRE(noisy.debounce(5).toString() == "1111");
+    REQUIRE(noisy.getCount() == 1);
+    REQUIRE(lab2::BinarySignal().debounce(5).getCount() == 0);
+    REQUIRE_THROWS_AS(signal.debounce(-1), std::invalid_argument);
+}
+
+TEST_CASE("SignalStats") {
+    lab2::BinarySignal signal("0011100101111000110");
+    SECTION("Whole signal") {
+        lab2::SignalStats stats(signal.view());
+        REQUIRE(stats.getRunCount() == signal.getCount());
+        REQUIRE(stats.getHighTime() == 10);
+        REQUIRE(stats.getLowTime() == 9);
+        REQUIRE(stats.totalTime() == 19);
+        REQUIRE(stats.dutyCycle() == Approx(10.0 / 19.0));
+        const lab2::PulseWidths &high = stats.pulses(true);
+        REQUIRE(high.count == 4);
+        REQUIRE(high.min == 1);
+        REQUIRE(high.max == 4);
+        REQUIRE(high.mean() == Approx(2.5));
+        REQUIRE(high.histogram[0] == 1);
+        REQUIRE(high.histogram[1] == 2);
+        REQUIRE(high.histogram[2] == 1);
+        const lab2::PulseWidths &low = stats.pulses(false);
+        REQUIRE(low.count == 3);
+        REQUIRE(low.min == 1);
+        REQUIRE(low.max == 3);
+        REQUIRE(lab2::SignalStats().dutyCycle() == 0.0);
+    }
+
+    SECTION("Merged chunks equal the whole") {
+        lab2::SignalStats whole(signal.view());
+        for (int a = 0; a <= 19; a++){
+            for (int b = a; b <= 19; b++){
+                lab2::SignalStats merged(signal.slice(0, a));
+                merged += lab2::SignalStats(signal.slice(a, b - a));
+                merged += lab2::SignalStats(signal.slice(b, 19 - b));
+                REQUIRE(merged.getRunCount() == whole.getRunCount());
+                REQUIRE(merged.getHighTime() == whole.getHighTime());
+                for (bool level : {false, true}){
+                    REQUIRE(merged.pulses(level).count == whole.pulses(level).count);
+                    REQUIRE(merged.pulses(level).total == whole.pulses(level).total);
+                    REQUIRE(merged.pulses(level).min == whole.pulses(level).min);
+                    REQUIRE(merged.pulses(level).max == whole.pulses(level).max);
+                    REQUIRE(merged.pulses(level).histogram == whole.pulses(level).histogram);
+                }
+            }
+        }
+    }
+
+    SECTION("Windows") {
+        std::vector<lab2::SignalStats> windows = lab2::SignalStats::windows(signal.view(), 8, 5);
+        REQUIRE(windows.size() == 4);
+        REQUIRE(windows[0].getHighTime() == 4);
+        REQUIRE(windows[1].totalTime() == 8);
+        REQUIRE(windows[3].totalTime() == 4);
+        REQUIRE(windows[3].getHighTime() == 2);
+        REQUIRE_THROWS_AS(lab2::SignalStats::windows(signal.view(), 0, 1), std::invalid_argument);
+
+        std::string pattern;
+        for (int i = 0; i < 300000; i++){
+            pattern += std::string(i % 3 + 1, (i % 2 == 0) ? '1' : '0');
+        }
+        lab2::BinarySignal large(pattern);
+        REQUIRE_FALSE(large.hasTimeIndex());
+        std::vector<lab2::SignalStats> unindexed = lab2::SignalStats::windows(large.view(), 200, 30);
+        large.buildTimeIndex();
+        std::vector<lab2::SignalStats> indexed = lab2::SignalStats::windows(large.view(), 200, 30);
+        REQUIRE(unindexed.size() == (pattern.size() + 29) / 30);
+        REQUIRE(unindexed.size() == indexed.size());
+        for (std::size_t i = 0; i < unindexed.size(); i += 997){
+            lab2::SignalStats expected(large.slice(i * 30, std::min<std::int64_t>(200, pattern.size() - i * 30)));
+            REQUIRE(unindexed[i].getRunCount() == expected.getRunCount());
+            REQUIRE(unindexed[i].getHighTime() == expected.getHighTime());
+            REQUIRE(unindexed[i].pulses(true).histogram == expected.pulses(true).histogram);
+            REQUIRE(unindexed[i].pulses(false).max == indexed[i].pulses(false).max);
+        }
+    }
+}
+
+TEST_CASE("Parallel paths match the serial ones") {
+    std::vector<std::uint8_t> samples;
+    unsigned state = 7;
+    bool current = true;
+    while (samples.size() < 1500000){
+        state = state * 1103515245u + 12345u;
+        samples.insert(samples.end(), 1 + (state >> 16) % 300, current ? 1 : 0);
+        current = !current;
+    }
+    std::vector<int> ints(samples.begin(), samples.end());
+    std::vector<std::uint64_t> bits((samples.size() + 63) / 64);
+    std::string text(samples.size(), '0');
+    for (std::size_t i = 0; i < samples.size(); i++){
+        bits[i / 64] |= (std::uint64_t)samples[i] << (i % 64);
+        text[i] = samples[i] ? '1' : '0';
+    }
+
+    lab2::setParallelThreads(1);
+    lab2::BinarySignal serial = lab2::BinarySignal::fromSamples(samples);
+    lab2::BinarySignal serial_repeated = serial * 3;
+    lab2::BinarySignal serial_odd = lab2::BinarySignal(std::string_view(text).substr(0, 1000001)) * 5;
+    lab2::setParallelThreads(4);
+    REQUIRE(lab2::parallelChunks(samples.size()) > 1);
+
+    lab2::BinarySignal parallel = lab2::BinarySignal::fromSamples(samples);
+    REQUIRE(parallel.getCount() == serial.getCount());
+    REQUIRE(parallel.totalTime() == serial.totalTime());
+    REQUIRE(parallel.toString() == text);
+    REQUIRE(lab2::BinarySignal::fromSamples(ints).toString() == text);
+    REQUIRE(lab2::BinarySignal::fromSamples(bits, samples.size()).toString() == text);
+    REQUIRE(lab2::BinarySignal(text).getCount() == serial.getCount());
+    REQUIRE(lab2::BinarySignal(std::string_view(text).substr(1, 1234567)).toString() == text.substr(1, 1234567));
+
+    lab2::BinarySignal repeated = parallel * 3;
+    REQUIRE(repeated.getCount() == serial_repeated.getCount());
+    REQUIRE(repeated.toString() == serial_repeated.toString());
+    lab2::BinarySignal odd = lab2::BinarySignal(std::string_view(text).substr(0, 1000001)) * 5;
+    REQUIRE(odd.getCount() == serial_odd.getCount());
+    REQUIRE(odd.toString() == serial_odd.toString());
+
+    repeated.buildTimeIndex();
+    for (std::int64_t time : {0LL, 777777LL, 3000000LL, 4499999LL}){
+        REQUIRE(repeated[time] == (text[time % text.size()] == '1'));
+    }
+
+    text[999999] = '2';
+    REQUIRE_THROWS_AS(lab2::BinarySignal(text), std::invalid_argument);
+    REQUIRE_THROWS_AS(lab2::parallelFor(8, [](std::size_t k){ if (k == 5) throw std::runtime_error("chunk"); }), std::runtime_error);
+
+    for (int round = 0; round < 200; round++){
+        std::vector<int> hits(64, 0);
+        lab2::parallelFor(hits.size(), [&hits](std::size_t k){
+            std::vector<int> inner(4, 0);
+            lab2::parallelFor(inner.size(), [&inner](std::size_t j){ inner[j] = 1; });
+            hits[k] = std::count(inner.begin(), inner.end(), 1);
+        });
+        REQUIRE(std::count(hits.begin(), hits.end(), 4) == 64);
+    }
+    std::atomic<int> total(0);
+    std::vector<std::thread> callers;
+    for (int c = 0; c < 4; c++){
+        callers.emplace_back([&total](){
+            for (int round = 0; round < 50; round++){
+                lab2::parallelFor(16, [&total](std::size_t){ total++; });
+            }
+        });
+    }
+    for (std::thread &caller : callers){
+        caller.join();
+    }
+    REQUIRE(total == 4 * 50 * 16);
+    lab2::setParallelThreads(0);
+}
+
+TEST_CASE("BinarySignalBuilder") {
+    SECTION("Samples and blocks") {
+        lab2::BinarySignalBuilder builder;
+        builder.append(true).append(true).append(false, 3);
+        std::vector<std::uint8_t> block = {0, 0, 1, 1, 0};
+        builder.append(std::span<const std::uint8_t>(block));
+        std::vector<int> ints = {0, 5, 5};
+        builder.append(std::span<const int>(ints));
+        builder.append(lab2::BinarySignal("10"));
+        builder.append(true, 0);
+        REQUIRE(builder.snapshot().toString() == "110000011001110");
+        REQUIRE(builder.getCount() == 6);
+        REQUIRE(builder.totalTime() == 15);
+        REQUIRE(builder.snapshot().isCanonical());
+        REQUIRE_THROWS_AS(builder.append(true, -1), std::invalid_argument);
+    }
+
+    SECTION("Snapshots are immutable") {
+        lab2::BinarySignalBuilder builder;
+        builder.append(true, 2);
+        lab2::BinarySignal first = builder.snapshot();
+        REQUIRE(first.isShared());
+        builder.append(true, 3).append(false);
+        lab2::BinarySignal second = builder.snapshot();
+        REQUIRE(first.toString() == "11");
+        REQUIRE(second.toString() == "111110");
+        builder.clear();
+        REQUIRE(builder.totalTime() == 0);
+        REQUIRE(second.totalTime() == 6);
+    }
+
+    SECTION("Ring mode") {
+        lab2::BinarySignalBuilder builder(10);
+        std::string capture;
+        for (int i = 0; i < 100; i++){
+            bool level = (i / 3) % 2 == 0;
+            builder.append(level);
+            capture += level ? '1' : '0';
+            REQUIRE(builder.totalTime() >= std::min(i + 1, 10));
+            REQUIRE(builder.totalTime() <= 20);
+            REQUIRE(builder.snapshot().toString() == capture.substr(builder.droppedTime()));
+        }
+        REQUIRE(builder.getHorizon() == 10);
+        REQUIRE(builder.droppedTime() + builder.totalTime() == 100);
+        REQUIRE_THROWS_AS(lab2::BinarySignalBuilder(-1), std::invalid_argument);
+        lab2::BinarySignalBuilder wide(std::numeric_limits<std::int64_t>::max() / 2 + 1);
+        wide.append(true, std::numeric_limits<std::int64_t>::max() / 2 + 1);
+        wide.append(false, 10);
+        REQUIRE(wide.droppedTime() == 0);
+        REQUIRE(wide.getCount() == 2);
+    }
+}
+
+TEST_CASE("ConcurrentSignal") {
+    SECTION("Single thread") {
+        lab2::ConcurrentSignal signal;
+        REQUIRE(signal.snapshot().getCount() == 0);
+        signal.append(true, 2);
+        lab2::ConcurrentSignal::Snapshot first = signal.snapshot();
+        signal.append(true, 1);
+        signal.append(false, 3);
+        signal.append(lab2::BinarySignal("0110"));
+        lab2::ConcurrentSignal::Snapshot second = signal.snapshot();
+        REQUIRE(first.totalTime() == 2);
+        REQUIRE(first.toSignal().toString() == "11");
+        REQUIRE(second.toSignal().toString() == "1110000110");
+        REQUIRE(second.getCount() == 4);
+        REQUIRE(second.getState(1).getTime() == 4);
+        REQUIRE(second.runIndexAt(9) == 3);
+        REQUIRE(second[7] == true);
+        REQUIRE_THROWS_AS(second[10], std::invalid_argument);
+        REQUIRE_THROWS_AS(signal.append(true, -1), std::invalid_argument);
+    }
+
+    SECTION("Readers during appends") {
+        lab2::ConcurrentSignal signal;
+        const int runs = 3 * CONCURRENT_CHUNK_RUNS;
+        std::atomic<bool> failed(false);
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 3; r++){
+            readers.emplace_back([&signal, &failed](){
+                std::int64_t seen = 0;
+                while (seen < runs){
+                    lab2::ConcurrentSignal::Snapshot snapshot = signal.snapshot();
+                    std::int64_t count = snapshot.getCount();
+                    if (count < seen){
+                        failed = true;
+                    }
+                    seen = count;
+                    if (count > 1){
+                        std::int64_t i = count / 2;
+                        lab2::SignalState state = snapshot.getState(i);
+                        if (state.getTime() != i % 7 + 1 || state.getLevel() != (i % 2 == 0)){
+                            failed = true;
+                        }
+                        if (snapshot.runIndexAt(snapshot.totalTime() - 1) != count - 1){
+                            failed = true;
+                        }
+                    }
+                }
+            });
+        }
+        for (int i = 0; i < runs; i++){
+            signal.append(i % 2 == 0, i % 7 + 1);
+        }
+        for (std::thread &reader : readers){
+            reader.join();
+        }
+        REQUIRE_FALSE(failed);
+        REQUIRE(signal.snapshot().getCount() == runs);
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef CHECKED_MATH_H
+#define CHECKED_MATH_H
+
+#include <stdexcept>
+
+template <class T>
+T checkedAdd(T a, T b){
+  T result;
+  if (__builtin_add_overflow(a, b, &result)) {
+    throw std::overflow_error("error: time overflow");
+  }
+  return result;
+}
+
+template <class T>
+T checkedMul(T a, T b){
+  T result;
+  if (__builtin_mul_overflow(a, b, &result)) {
+    throw std::overflow_error("error: time overflow");
+  }
+  return result;
+}
+
+#endif //CHECKED_MATH_H